@@ -0,0 +1,423 @@
+//
+//  retryxx_bench.cpp
+//  retryxx
+//
+//  MIT License
+//
+//  Copyright (c) 2025 Jacob Sologub
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+#include <retryxx/retryxx_executor.h>
+#include <retryxx/retryxx_metrics.h>
+#include <retryxx/retryxx_policy_registry.h>
+#include <retryxx/retryxx_retry.h>
+#include <retryxx/retryxx_retry_task.h>
+#include <retryxx/retryxx_scheduler.h>
+#include <retryxx/retryxx_static_policy.h>
+#include <retryxx/retryxx_trace.h>
+#include <retryxx/retryxx_virtual_clock.h>
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+namespace
+{
+
+int statusCode = 200;
+
+int makeCall()
+{
+    benchmark::DoNotOptimize (statusCode);
+    return statusCode;
+}
+
+} // namespace
+
+/// Baseline for the first-success benchmark: the same call without retry().
+static void BM_DirectCall (benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize (makeCall());
+    }
+}
+
+BENCHMARK (BM_DirectCall);
+
+/// retry() around a call that succeeds on the first attempt.
+static void BM_RetryFirstSuccess (benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        auto result = retryxx::retry ([] { return makeCall(); },
+                                      [] (int code) { return code != 200; },
+                                      [] (const std::exception&) { return true; });
+        benchmark::DoNotOptimize (result);
+    }
+}
+
+BENCHMARK (BM_RetryFirstSuccess);
+
+/// BM_RetryFirstSuccess with every attempt counted by a shared RetryMetrics.
+static void BM_RetryFirstSuccessWithMetrics (benchmark::State& state)
+{
+    static retryxx::RetryMetrics metrics;
+
+    for (auto _ : state)
+    {
+        auto result = retryxx::retry ([] { return makeCall(); },
+                                      [] (int code) { return code != 200; },
+                                      [] (const std::exception&) { return true; },
+                                      5,
+                                      retryxx::BackoffPolicy{},
+                                      {},
+                                      retryxx::BasicRetryOptions<retryxx::RetryMetrics*> { .observer = &metrics });
+        benchmark::DoNotOptimize (result);
+    }
+}
+
+BENCHMARK (BM_RetryFirstSuccessWithMetrics)->ThreadRange (1, 8);
+
+/// BM_RetryFirstSuccess with a per-attempt timeout armed on the shared watchdog.
+static void BM_RetryFirstSuccessWithAttemptTimeout (benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        auto result = retryxx::retry ([] (retryxx::stop_token) { return makeCall(); },
+                                      [] (int code) { return code != 200; },
+                                      [] (const std::exception&) { return true; },
+                                      5,
+                                      retryxx::BackoffPolicy{},
+                                      {},
+                                      retryxx::RetryOptions { .attemptTimeout = std::chrono::seconds (1) });
+        benchmark::DoNotOptimize (result);
+    }
+}
+
+BENCHMARK (BM_RetryFirstSuccessWithAttemptTimeout)->ThreadRange (1, 8);
+
+/// BM_RetryFirstSuccess traced into a TraceBuffer sampling one retry in N, drained every 1024 calls.
+static void BM_RetryFirstSuccessWithTrace (benchmark::State& state)
+{
+    retryxx::TraceBuffer traces (4096, static_cast<std::uint32_t> (state.range (0)));
+    std::size_t calls = 0;
+
+    for (auto _ : state)
+    {
+        auto result = retryxx::retry ([] { return makeCall(); },
+                                      [] (int code) { return code != 200; },
+                                      [] (const std::exception&) { return true; },
+                                      5,
+                                      retryxx::BackoffPolicy{},
+                                      {},
+                                      retryxx::BasicRetryOptions<retryxx::TraceObserver> { .observer = traces.observe() });
+        benchmark::DoNotOptimize (result);
+
+        if (++calls % 1024 == 0)
+        {
+            traces.drain ([] (const retryxx::AttemptRecord& record) { benchmark::DoNotOptimize (record); });
+        }
+    }
+}
+
+BENCHMARK (BM_RetryFirstSuccessWithTrace)->Arg (1)->Arg (100);
+
+/// Cost of computing a jittered delay, which should not depend on the attempt number.
+static void BM_GetDelay (benchmark::State& state)
+{
+    retryxx::BackoffPolicy policy (std::chrono::milliseconds (100), 1.5, std::chrono::minutes (5));
+    auto attempt = static_cast<int> (state.range (0));
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize (policy.getDelay (attempt));
+    }
+}
+
+BENCHMARK (BM_GetDelay)->Arg (1)->Arg (10)->Arg (100)->Arg (1000);
+
+/// getDelay() over a run of attempts for each jitter strategy.
+template <typename Jitter>
+static void BM_GetDelayJitter (benchmark::State& state)
+{
+    retryxx::JitteredBackoffPolicy<Jitter> policy (std::chrono::milliseconds (100), 2.0, std::chrono::seconds (30));
+
+    for (auto _ : state)
+    {
+        for (int attempt = 1; attempt <= 8; ++attempt)
+        {
+            benchmark::DoNotOptimize (policy.getDelay (attempt));
+        }
+    }
+}
+
+BENCHMARK_TEMPLATE (BM_GetDelayJitter, retryxx::NoJitter);
+BENCHMARK_TEMPLATE (BM_GetDelayJitter, retryxx::FullJitter);
+BENCHMARK_TEMPLATE (BM_GetDelayJitter, retryxx::EqualJitter);
+BENCHMARK_TEMPLATE (BM_GetDelayJitter, retryxx::DecorrelatedJitter);
+
+/// The same run of attempts against a compile-time schedule, leaving only the jitter draw.
+template <typename Jitter>
+static void BM_GetDelayStatic (benchmark::State& state)
+{
+    retryxx::StaticBackoffPolicy<9, 100, 2.0, 30000, Jitter> policy;
+
+    for (auto _ : state)
+    {
+        for (int attempt = 1; attempt <= 8; ++attempt)
+        {
+            benchmark::DoNotOptimize (policy.getDelay (attempt));
+        }
+    }
+}
+
+BENCHMARK_TEMPLATE (BM_GetDelayStatic, retryxx::NoJitter);
+BENCHMARK_TEMPLATE (BM_GetDelayStatic, retryxx::FullJitter);
+
+/// Looking up an endpoint's settings in a RetryPolicyRegistry of N endpoints from several threads.
+static void BM_RegistryLookup (benchmark::State& state)
+{
+    static retryxx::RetryPolicyRegistry<int> registry ([] {
+        std::vector<std::pair<int, retryxx::EndpointPolicy<>>> policies;
+
+        for (int endpoint = 0; endpoint < 1000; ++endpoint)
+        {
+            policies.push_back ({ endpoint, { retryxx::BackoffPolicy{}, endpoint % 10 + 1 } });
+        }
+
+        return policies;
+    }());
+
+    int endpoint = state.thread_index();
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize (registry.get (endpoint));
+        endpoint = (endpoint + 7) % 1000;
+    }
+}
+
+BENCHMARK (BM_RegistryLookup)->ThreadRange (1, 8);
+
+/// A whole default schedule, ten attempts with backoffs from 1 s up to 5 minutes, run in virtual time.
+static void BM_RetryScheduleVirtualClock (benchmark::State& state)
+{
+    retryxx::BasicRetryOptions<retryxx::NoObserver, retryxx::VirtualClock> options;
+
+    for (auto _ : state)
+    {
+        auto result = retryxx::retry ([] { return makeCall(); },
+                                      [] (int code) { return code == 200; },
+                                      [] (const std::exception&) { return true; },
+                                      10,
+                                      retryxx::BackoffPolicy{},
+                                      {},
+                                      options);
+        benchmark::DoNotOptimize (result);
+    }
+}
+
+BENCHMARK (BM_RetryScheduleVirtualClock);
+
+/// retry() giving up because every attempt was rejected by the predicate.
+static void BM_RetryExhausted (benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        auto result = retryxx::retry ([] { return makeCall(); },
+                                      [] (int) { return true; },
+                                      [] (const std::exception&) { return true; },
+                                      1);
+        benchmark::DoNotOptimize (result);
+    }
+}
+
+BENCHMARK (BM_RetryExhausted);
+
+/// retry() giving up on an exception the predicate refuses to retry.
+static void BM_RetryNonRetryableException (benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        auto result = retryxx::retry ([]() -> int { throw std::runtime_error ("unavailable"); },
+                                      [] (int) { return true; },
+                                      [] (const std::exception&) { return false; });
+        benchmark::DoNotOptimize (result);
+    }
+}
+
+BENCHMARK (BM_RetryNonRetryableException);
+
+/// retry_expected() giving up on an error value the predicate refuses to retry, the
+/// exception-free counterpart of BM_RetryNonRetryableException.
+static void BM_RetryExpectedNonRetryableError (benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        auto result = retryxx::retry_expected ([]() -> retryxx::expected<int, int> { return retryxx::unexpected (makeCall()); },
+                                               [] (int) { return false; });
+        benchmark::DoNotOptimize (result);
+    }
+}
+
+BENCHMARK (BM_RetryExpectedNonRetryableError);
+
+/// Time from request_stop() until a thread blocked in interruptibleSleep() has returned.
+static void BM_InterruptibleSleepCancellation (benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        retryxx::stop_source source;
+        std::atomic<bool> sleeping { false };
+
+        std::thread sleeper ([&]
+        {
+            sleeping = true;
+            retryxx::detail::interruptibleSleep (std::chrono::seconds (10), source.get_token());
+        });
+
+        while (! sleeping)
+        {
+            std::this_thread::yield();
+        }
+
+        std::this_thread::sleep_for (std::chrono::milliseconds (1));
+
+        auto start = std::chrono::steady_clock::now();
+        source.request_stop();
+        sleeper.join();
+
+        state.SetIterationTime (std::chrono::duration<double> (std::chrono::steady_clock::now() - start).count());
+    }
+}
+
+BENCHMARK (BM_InterruptibleSleepCancellation)->UseManualTime()->Unit (benchmark::kMicrosecond);
+
+/// Throughput of a RetryScheduler with N retries waiting out a backoff at the same time.
+/// Every retry fails once, waits up to 50 ms in the timer wheel and then succeeds.
+static void BM_SchedulerPendingRetries (benchmark::State& state)
+{
+    retryxx::RetryScheduler scheduler;
+    retryxx::BackoffPolicy policy (std::chrono::milliseconds (50), 1.0, std::chrono::milliseconds (50));
+
+    std::vector<std::future<retryxx::expected<int, retryxx::RetryError>>> futures;
+    futures.reserve (static_cast<std::size_t> (state.range (0)));
+
+    for (auto _ : state)
+    {
+        for (int64_t i = 0; i < state.range (0); ++i)
+        {
+            futures.push_back (retryxx::retry_async (scheduler,
+                                                     [attempt = 0]() mutable { return ++attempt; },
+                                                     [] (int attempt) { return attempt < 2; },
+                                                     [] (const std::exception&) { return true; },
+                                                     2,
+                                                     policy));
+        }
+
+        for (auto& future : futures)
+        {
+            benchmark::DoNotOptimize (future.get());
+        }
+
+        futures.clear();
+    }
+
+    state.SetItemsProcessed (state.iterations() * state.range (0));
+}
+
+BENCHMARK (BM_SchedulerPendingRetries)->Arg (100000)->Unit (benchmark::kMillisecond)->UseRealTime();
+
+/// The same workload submitted to a RetryExecutor with one worker per hardware thread.
+static void BM_ExecutorPendingRetries (benchmark::State& state)
+{
+    retryxx::RetryExecutor executor;
+    retryxx::BackoffPolicy policy (std::chrono::milliseconds (50), 1.0, std::chrono::milliseconds (50));
+
+    std::vector<std::future<retryxx::expected<int, retryxx::RetryError>>> futures;
+    futures.reserve (static_cast<std::size_t> (state.range (0)));
+
+    for (auto _ : state)
+    {
+        for (int64_t i = 0; i < state.range (0); ++i)
+        {
+            futures.push_back (executor.submit ([attempt = 0]() mutable { return ++attempt; },
+                                                [] (int attempt) { return attempt < 2; },
+                                                [] (const std::exception&) { return true; },
+                                                2,
+                                                policy));
+        }
+
+        for (auto& future : futures)
+        {
+            benchmark::DoNotOptimize (future.get());
+        }
+
+        futures.clear();
+    }
+
+    state.SetItemsProcessed (state.iterations() * state.range (0));
+}
+
+BENCHMARK (BM_ExecutorPendingRetries)->Arg (100000)->Unit (benchmark::kMillisecond)->UseRealTime();
+
+/// Queues pending retries as RetryTasks in a contiguous array and drives them to completion,
+/// the attempt pattern of the scheduler benchmarks without the threads or the waiting.
+static void BM_RetryTaskQueue (benchmark::State& state)
+{
+    retryxx::BackoffPolicy policy (std::chrono::milliseconds (50), 1.0, std::chrono::milliseconds (50));
+    int completed = 0;
+
+    std::vector<retryxx::RetryTask> tasks;
+    tasks.reserve (static_cast<std::size_t> (state.range (0)));
+
+    for (auto _ : state)
+    {
+        for (int64_t i = 0; i < state.range (0); ++i)
+        {
+            tasks.push_back (retryxx::makeRetryTask ([attempt = 0]() mutable { return ++attempt; },
+                                                     [] (int attempt) { return attempt < 2; },
+                                                     [] (const std::exception&) { return true; },
+                                                     [&completed] (retryxx::expected<int, retryxx::RetryError> result) { completed += result.has_value(); },
+                                                     2,
+                                                     policy));
+        }
+
+        for (auto& task : tasks)
+        {
+            while (! task.run())
+            {
+                benchmark::DoNotOptimize (task.nextDelay());
+            }
+        }
+
+        tasks.clear();
+    }
+
+    benchmark::DoNotOptimize (completed);
+    state.SetItemsProcessed (state.iterations() * state.range (0));
+}
+
+BENCHMARK (BM_RetryTaskQueue)->Arg (100000)->Unit (benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,189 @@
+//
+//  retryxx_adaptive.h
+//  retryxx
+//
+//  MIT License
+//
+//  Copyright (c) 2025 Jacob Sologub
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+#pragma once
+
+#include "retryxx_retry.h"
+
+namespace retryxx
+{
+
+/// Backoff state shared by every retry against one dependency, learned from the
+/// outcome and latency of each attempt. Create one per dependency, keep it alive for as
+/// long as any retry uses it and pass AdaptiveBackoffPolicy { shared } to retry().
+///
+/// The base delay follows AIMD: every failed attempt multiplies it by increaseFactor and
+/// every accepted one takes decreaseStep off it, so it stays near minDelay while the
+/// dependency is healthy and backs off quickly when it starts failing. A base delay below
+/// 1 ms, as with a minDelay of zero, grows from 1 ms so that failures still back off.
+/// Exponentially weighted moving averages of the error rate and of the attempt latency
+/// then shape the delay of each retry:
+///
+///     delay = base * (fast latency / slow latency) * (1 + error rate)^(attempt - 1)
+///
+/// clamped to [minDelay, maxDelay] with full jitter applied. The latency ratio compares
+/// a fast-moving average with a slow-moving baseline, so a dependency that is slowing
+/// down is given more room before the same error rate shows it.
+///
+/// The base delay and the three averages are separate atomics, each updated by its own
+/// lock-free compare-and-swap loop, so no lock is taken. Each value is always consistent
+/// with itself, but a delay computed while another thread records an outcome may combine
+/// old and new values. This only shifts that one delay slightly.
+class AdaptiveBackoff
+{
+public:
+    /// Creates the shared state of an adaptive backoff.
+    /// @param minDelay         Shortest base delay, used while the dependency is healthy (default: 10 ms)
+    /// @param maxDelay         Longest delay ever returned (default: 30 seconds)
+    /// @param increaseFactor   Multiplies the base delay after each failed attempt (default: 2.0)
+    /// @param decreaseStep     Subtracted from the base delay after each accepted attempt (default: 10 ms)
+    /// @param smoothing        Weight of each new sample in the moving averages, in (0, 1] (default: 0.1)
+    explicit AdaptiveBackoff (std::chrono::milliseconds minDelay = std::chrono::milliseconds (10),
+                              std::chrono::milliseconds maxDelay = std::chrono::seconds (30),
+                              double increaseFactor = 2.0,
+                              std::chrono::milliseconds decreaseStep = std::chrono::milliseconds (10),
+                              double smoothing = 0.1)
+      : minMicros (toMicros (minDelay)),
+        maxMicros (std::max (toMicros (maxDelay), toMicros (minDelay))),
+        decreaseMicros (toMicros (decreaseStep)),
+        increaseFactor (std::max (increaseFactor, 1.0)),
+        fastSmoothing (std::clamp (smoothing, 1e-6, 1.0)),
+        slowSmoothing (fastSmoothing / 10.0),
+        baseMicros (toMicros (minDelay))
+    {
+    }
+
+    AdaptiveBackoff (const AdaptiveBackoff&) = delete;
+    AdaptiveBackoff& operator= (const AdaptiveBackoff&) = delete;
+
+    /// Folds the outcome of one attempt into the shared state.
+    /// @param succeeded    Whether the attempt's result was accepted
+    /// @param latency      How long the attempt took
+    void recordOutcome (bool succeeded, std::chrono::nanoseconds latency) noexcept
+    {
+        update (errorRate, fastSmoothing, succeeded ? 0.0 : 1.0);
+
+        auto sample = static_cast<double> (latency.count());
+        update (fastLatency, fastSmoothing, sample);
+        update (slowLatency, slowSmoothing, sample);
+
+        auto base = baseMicros.load (std::memory_order_relaxed);
+        std::int64_t next;
+
+        do
+        {
+            next = succeeded ? std::max (base - decreaseMicros, minMicros)
+                             : std::min (static_cast<std::int64_t> (static_cast<double> (std::max (base, increaseFloorMicros)) * increaseFactor), maxMicros);
+        }
+        while (next != base && ! baseMicros.compare_exchange_weak (base, next, std::memory_order_relaxed));
+    }
+
+    /// Calculates the delay for the given retry attempt before jitter is applied.
+    /// @param attempt   The retry attempt number (1-based)
+    /// @returns         The adapted delay, between minDelay and maxDelay
+    std::chrono::milliseconds getBaseDelay (int attempt) const noexcept
+    {
+        auto slow = slowLatency.load (std::memory_order_relaxed);
+        auto congestion = slow > 0.0 ? std::max (fastLatency.load (std::memory_order_relaxed) / slow, 1.0) : 1.0;
+        auto growth = std::pow (1.0 + getErrorRate(), std::max (attempt - 1, 0));
+        auto delay = static_cast<double> (baseMicros.load (std::memory_order_relaxed)) * congestion * growth;
+
+        delay = std::clamp (delay, static_cast<double> (minMicros), static_cast<double> (maxMicros));
+        return std::chrono::duration_cast<std::chrono::milliseconds> (std::chrono::microseconds (static_cast<std::int64_t> (delay)));
+    }
+
+    /// Calculates the randomized delay for the given retry attempt.
+    /// @param attempt   The retry attempt number (1-based)
+    /// @returns         Random delay between 0 and getBaseDelay (attempt)
+    std::chrono::milliseconds getDelay (int attempt) const
+    {
+        std::uniform_int_distribution<long long> dist (0, getBaseDelay (attempt).count());
+        return std::chrono::milliseconds (dist (detail::threadLocalRng<SplitMix64>()));
+    }
+
+    /// Returns the moving average of the fraction of attempts that failed
+    double getErrorRate() const noexcept    { return errorRate.load (std::memory_order_relaxed); }
+
+    /// Returns the fast-moving average of the attempt latency
+    std::chrono::nanoseconds getAverageLatency() const noexcept
+    {
+        return std::chrono::nanoseconds (static_cast<std::int64_t> (std::max (fastLatency.load (std::memory_order_relaxed), 0.0)));
+    }
+
+private:
+    static constexpr std::int64_t increaseFloorMicros = 1000;
+
+    static std::int64_t toMicros (std::chrono::milliseconds delay) noexcept
+    {
+        return std::max<std::int64_t> (std::chrono::duration_cast<std::chrono::microseconds> (delay).count(), 0);
+    }
+
+    // Averages that start out negative take their first sample as is, so the latency
+    // baseline is not dragged towards zero while it warms up
+    static void update (std::atomic<double>& average, double weight, double sample) noexcept
+    {
+        auto current = average.load (std::memory_order_relaxed);
+        while (! average.compare_exchange_weak (current,
+                                                current < 0.0 ? sample : current + weight * (sample - current),
+                                                std::memory_order_relaxed))
+        {
+        }
+    }
+
+    const std::int64_t minMicros;
+    const std::int64_t maxMicros;
+    const std::int64_t decreaseMicros;
+    const double increaseFactor;
+    const double fastSmoothing;
+    const double slowSmoothing;
+    std::atomic<std::int64_t> baseMicros;
+    std::atomic<double> errorRate { 0.0 };
+    std::atomic<double> fastLatency { -1.0 };
+    std::atomic<double> slowLatency { -1.0 };
+};
+
+/// Backoff policy handle onto an AdaptiveBackoff. It is a single pointer, so passing it
+/// to retry() by value is free, and every copy reports into and reads from the same state.
+struct AdaptiveBackoffPolicy
+{
+    AdaptiveBackoff* shared;
+
+    AdaptiveBackoffPolicy (AdaptiveBackoff& state) noexcept : shared (&state) {}
+
+    /// Forwards the outcome of an attempt to the shared state
+    void recordOutcome (bool succeeded, std::chrono::nanoseconds latency) const noexcept
+    {
+        shared->recordOutcome (succeeded, latency);
+    }
+
+    /// Returns the shared state's randomized delay for the given retry attempt
+    std::chrono::milliseconds getDelay (int attempt) const    { return shared->getDelay (attempt); }
+};
+
+static_assert (AdaptiveBackoffStrategy<AdaptiveBackoffPolicy>);
+
+} // namespace retryxx
@@ -0,0 +1,146 @@
+//
+//  retryxx_asio.h
+//  retryxx
+//
+//  MIT License
+//
+//  Copyright (c) 2025 Jacob Sologub
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+#pragma once
+
+#include "retryxx_coroutine.h"
+
+#include <memory>
+#include <optional>
+
+#if __has_include(<asio.hpp>)
+#include <asio.hpp>
+
+namespace retryxx::detail
+{
+    namespace asio = ::asio;
+}
+
+#elif __has_include(<boost/asio.hpp>)
+#include <boost/asio.hpp>
+
+namespace retryxx::detail
+{
+    namespace asio = ::boost::asio;
+}
+
+#else
+ #error "retryxx_asio.h requires either standalone Asio or Boost.Asio"
+#endif
+
+namespace retryxx
+{
+
+/// CoroutineExecutor adapter for an Asio io_context, so co_retry resumes on the
+/// threads running the context and its backoff waits on an Asio steady_timer.
+class AsioExecutor
+{
+public:
+    explicit AsioExecutor (detail::asio::io_context& ioContext) noexcept : context (ioContext) {}
+
+    /// Returns an awaitable that resumes the awaiting coroutine on the io_context
+    auto schedule() noexcept
+    {
+        struct Awaiter
+        {
+            bool await_ready() const noexcept  { return false; }
+            void await_resume() const noexcept {}
+
+            void await_suspend (std::coroutine_handle<> handle)
+            {
+                detail::asio::post (context, [handle] { handle.resume(); });
+            }
+
+            detail::asio::io_context& context;
+        };
+
+        return Awaiter { context };
+    }
+
+    /// Returns an awaitable that resumes the awaiting coroutine on the io_context after delay,
+    /// or as soon as stop is requested on stopToken. Without a stop token the timer lives in
+    /// the awaiting coroutine's frame, so waiting does not allocate.
+    auto scheduleAfter (std::chrono::milliseconds delay, stop_token stopToken = stop_token{})
+    {
+        // With a stop token the timer is shared with the completion handler, as the
+        // coroutine can resume on another thread before await_suspend() has returned
+        struct CancellableTimer
+        {
+            struct Cancel
+            {
+                void operator()() const
+                {
+                    if (auto self = state.lock())
+                    {
+                        detail::asio::post (self->timer.get_executor(), [self] { self->timer.cancel(); });
+                    }
+                }
+
+                std::weak_ptr<CancellableTimer> state;
+            };
+
+            explicit CancellableTimer (detail::asio::io_context& context) : timer (context) {}
+
+            detail::asio::steady_timer timer;
+            std::optional<stop_callback<Cancel>> onStop;
+        };
+
+        struct Awaiter
+        {
+            bool await_ready() const noexcept  { return stopToken.stop_requested(); }
+            void await_resume() const noexcept {}
+
+            void await_suspend (std::coroutine_handle<> handle)
+            {
+                if (! stopToken.stop_possible())
+                {
+                    timer.expires_after (delay);
+                    timer.async_wait ([handle] (const auto&) { handle.resume(); });
+                    return;
+                }
+
+                auto token = stopToken;
+                auto state = std::make_shared<CancellableTimer> (context);
+                state->timer.expires_after (delay);
+                state->timer.async_wait ([handle, state] (const auto&) { handle.resume(); });
+                state->onStop.emplace (token, typename CancellableTimer::Cancel { state });
+            }
+
+            detail::asio::io_context& context;
+            detail::asio::steady_timer timer;
+            std::chrono::milliseconds delay;
+            stop_token stopToken;
+        };
+
+        return Awaiter { context, detail::asio::steady_timer (context), delay, std::move (stopToken) };
+    }
+
+private:
+    detail::asio::io_context& context;
+};
+
+} // namespace retryxx
@@ -0,0 +1,209 @@
+//
+//  retryxx_batch.h
+//  retryxx
+//
+//  MIT License
+//
+//  Copyright (c) 2025 Jacob Sologub
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+#pragma once
+
+#include "retryxx_retry.h"
+
+#include <span>
+#include <vector>
+
+namespace retryxx
+{
+
+/// Outcome of retry_batch().
+template <typename Status>
+struct BatchResult
+{
+    /// Latest status of every item, in input order. Items that were never reported on
+    /// keep a value-initialized status.
+    std::vector<Status> statuses;
+
+    /// Indices of the items whose latest status still asked for a retry when the retries
+    /// ended, in input order. An item whose status the predicate declined to retry is
+    /// settled and not listed here whether it succeeded or failed for good, so check its
+    /// entry in statuses to tell the two apart.
+    std::vector<std::size_t> failedItems;
+
+    /// Why retry_batch() stopped with items still wanting a retry, empty if none were left
+    std::optional<RetryError> error;
+
+    /// Returns true if no item was left wanting a retry
+    explicit operator bool() const noexcept { return failedItems.empty(); }
+};
+
+/// Executes a bulk operation with retry logic, re-submitting only the items that failed.
+/// func is called with a span of items and returns one status per item, in the same
+/// order. Each backoff round coalesces every item whose status asks to be retried into
+/// a single new call, so items that are settled are never sent again. The predicate only
+/// says which statuses to retry, so an item that failed with a status it declines counts
+/// as settled: it ends up in statuses but not in failedItems.
+/// @param items                            The items to submit
+/// @param func                             Callable taking std::span<const T>, optionally after a stop_token, and returning std::vector<Status>
+/// @param shouldRetryItemPredicate         Determines if an item's status should trigger a retry of that item
+/// @param shouldRetryExceptionPredicate    Determines if exception should trigger a retry of the pending items
+/// @param maxAttempts                      Maximum number of calls
+/// @param backoffPolicy                    Timing configuration for retries
+/// @param stopToken                        Token for cooperative cancellation of retry operation
+/// @param options                          Optional shared collaborators such as a RetryBudget
+/// @returns                                The final status of every item
+template <typename T, typename F,
+          typename ShouldRetryItemPredicate,
+          typename ShouldRetryExceptionPredicate,
+          BackoffStrategy Policy = BackoffPolicy,
+          typename Status = typename detail::AttemptResult<F, std::span<const T>>::value_type,
+          typename Observer = NoObserver,
+          typename Clock = SteadyClock>
+BatchResult<Status> retry_batch (std::span<const T> items,
+                                 F&& func,
+                                 ShouldRetryItemPredicate&& shouldRetryItemPredicate,
+                                 ShouldRetryExceptionPredicate&& shouldRetryExceptionPredicate,
+                                 int maxAttempts = 5,
+                                 Policy backoffPolicy = Policy{},
+                                 stop_token stopToken = stop_token{},
+                                 const BasicRetryOptions<Observer, Clock>& options = {})
+{
+    BatchResult<Status> batch;
+    batch.statuses.resize (items.size());
+    batch.failedItems.resize (items.size());
+
+    for (std::size_t i = 0; i < items.size(); ++i)
+    {
+        batch.failedItems[i] = i;
+    }
+
+    std::vector<T> pendingItems;
+    std::vector<std::size_t> stillFailing;
+    auto pending = items;
+
+    // Runs one round against the items that are still failing
+    auto attempt = [&] (const stop_token& attemptToken)
+    {
+        return detail::invokeAttempt (func, attemptToken, pending);
+    };
+
+    // Folds a round's statuses into the batch and decides whether another round is needed,
+    // waiting out the longest explicit delay any of the failed items asked for
+    auto mergeRound = [&] (std::vector<Status>& roundStatuses)
+    {
+        stillFailing.clear();
+        auto decision = RetryDecision::retry();
+
+        for (std::size_t i = 0; i < batch.failedItems.size(); ++i)
+        {
+            auto index = batch.failedItems[i];
+
+            if (i >= roundStatuses.size())
+            {
+                stillFailing.push_back (index);
+                continue;
+            }
+
+            batch.statuses[index] = std::move (roundStatuses[i]);
+            RetryDecision itemDecision = shouldRetryItemPredicate (batch.statuses[index]);
+
+            if (itemDecision.shouldRetry())
+            {
+                stillFailing.push_back (index);
+
+                if (itemDecision.getKind() == RetryDecision::Kind::retryAfter
+                    && (decision.getKind() != RetryDecision::Kind::retryAfter || itemDecision.getDelay() > decision.getDelay()))
+                {
+                    decision = itemDecision;
+                }
+            }
+        }
+
+        batch.failedItems.swap (stillFailing);
+
+        pendingItems.clear();
+        for (auto index : batch.failedItems)
+        {
+            pendingItems.push_back (items[index]);
+        }
+
+        pending = pendingItems;
+        return batch.failedItems.empty() ? RetryDecision::stop() : decision;
+    };
+
+    detail::RetryLoop<std::vector<Status>, decltype (mergeRound)&, ShouldRetryExceptionPredicate&&, Policy, Observer, Clock> loop (
+        mergeRound,
+        std::forward<ShouldRetryExceptionPredicate> (shouldRetryExceptionPredicate),
+        items.empty() ? std::min (maxAttempts, 1) : maxAttempts,
+        std::move (backoffPolicy),
+        options);
+
+    if (items.empty())
+    {
+        return batch;
+    }
+
+    while (! loop.runAttempt (attempt, stopToken))
+    {
+        if (options.clock.sleepFor (loop.nextDelay(), stopToken))
+        {
+            loop.cancel();
+            break;
+        }
+    }
+
+    if (auto outcome = loop.takeResult(); ! outcome)
+    {
+        batch.error = std::move (outcome.error());
+    }
+
+    return batch;
+}
+
+/// Convenience overload of retry_batch() for any contiguous range of items, such as a std::vector.
+template <std::ranges::contiguous_range Items, typename F,
+          typename ShouldRetryItemPredicate,
+          typename ShouldRetryExceptionPredicate,
+          BackoffStrategy Policy = BackoffPolicy,
+          typename Observer = NoObserver,
+          typename Clock = SteadyClock>
+auto retry_batch (const Items& items,
+                  F&& func,
+                  ShouldRetryItemPredicate&& shouldRetryItemPredicate,
+                  ShouldRetryExceptionPredicate&& shouldRetryExceptionPredicate,
+                  int maxAttempts = 5,
+                  Policy backoffPolicy = Policy{},
+                  stop_token stopToken = stop_token{},
+                  const BasicRetryOptions<Observer, Clock>& options = {})
+{
+    using T = std::ranges::range_value_t<Items>;
+    return retry_batch (std::span<const T> (std::ranges::data (items), std::ranges::size (items)),
+                        std::forward<F> (func),
+                        std::forward<ShouldRetryItemPredicate> (shouldRetryItemPredicate),
+                        std::forward<ShouldRetryExceptionPredicate> (shouldRetryExceptionPredicate),
+                        maxAttempts,
+                        std::move (backoffPolicy),
+                        std::move (stopToken),
+                        options);
+}
+
+} // namespace retryxx
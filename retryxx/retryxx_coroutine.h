@@ -0,0 +1,448 @@
+//
+//  retryxx_coroutine.h
+//  retryxx
+//
+//  MIT License
+//
+//  Copyright (c) 2025 Jacob Sologub
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+#pragma once
+
+#include "retryxx_retry.h"
+
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace retryxx
+{
+
+/// Lazily started coroutine producing a value of type T.
+/// The coroutine body runs when the task is first awaited or passed to spawn().
+template <typename T>
+class Task
+{
+public:
+    struct promise_type
+    {
+        Task get_return_object() noexcept
+        {
+            return Task (std::coroutine_handle<promise_type>::from_promise (*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept  { return {}; }
+
+        auto final_suspend() noexcept
+        {
+            struct FinalAwaiter
+            {
+                bool await_ready() const noexcept  { return false; }
+                void await_resume() const noexcept {}
+
+                std::coroutine_handle<> await_suspend (std::coroutine_handle<promise_type> handle) noexcept
+                {
+                    auto continuation = handle.promise().continuation;
+                    return continuation ? continuation : std::noop_coroutine();
+                }
+            };
+
+            return FinalAwaiter{};
+        }
+
+        template <typename U>
+        void return_value (U&& result)  { value.emplace (std::forward<U> (result)); }
+
+        void unhandled_exception()      { exception = std::current_exception(); }
+
+        std::optional<T> value;
+        std::exception_ptr exception;
+        std::coroutine_handle<> continuation;
+    };
+
+    Task (Task&& other) noexcept : handle (std::exchange (other.handle, nullptr)) {}
+
+    Task& operator= (Task&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            handle = std::exchange (other.handle, nullptr);
+        }
+
+        return *this;
+    }
+
+    ~Task() { reset(); }
+
+    /// Starts the task and suspends the awaiting coroutine until it completes
+    auto operator co_await() && noexcept
+    {
+        struct Awaiter
+        {
+            bool await_ready() const noexcept  { return false; }
+
+            std::coroutine_handle<> await_suspend (std::coroutine_handle<> awaiting) noexcept
+            {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+
+            T await_resume()
+            {
+                if (handle.promise().exception)
+                {
+                    std::rethrow_exception (handle.promise().exception);
+                }
+
+                return std::move (*handle.promise().value);
+            }
+
+            std::coroutine_handle<promise_type> handle;
+        };
+
+        return Awaiter { handle };
+    }
+
+private:
+    explicit Task (std::coroutine_handle<promise_type> h) noexcept : handle (h) {}
+
+    void reset() noexcept
+    {
+        if (handle)
+        {
+            handle.destroy();
+        }
+    }
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+/// An executor that co_retry can resume on. schedule() must return an awaitable that
+/// resumes the awaiting coroutine on the executor, scheduleAfter() one that does the
+/// same once the delay has elapsed. If scheduleAfter() also takes a stop_token after the
+/// delay, co_retry passes its token and expects the wait to end early once stop is requested.
+template <typename E>
+concept CoroutineExecutor = requires (E& executor, std::chrono::milliseconds delay)
+{
+    executor.schedule();
+    executor.scheduleAfter (delay);
+};
+
+/// Minimal single-threaded executor. Coroutines scheduled on it, from any thread,
+/// are resumed by whichever thread is inside run().
+class RunLoop
+{
+public:
+    RunLoop() = default;
+    RunLoop (const RunLoop&) = delete;
+    RunLoop& operator= (const RunLoop&) = delete;
+
+    /// Returns an awaitable that resumes the awaiting coroutine inside run()
+    auto schedule() noexcept
+    {
+        struct Awaiter
+        {
+            bool await_ready() const noexcept  { return false; }
+            void await_resume() const noexcept {}
+            void await_suspend (std::coroutine_handle<> handle)  { loop.post (handle, std::chrono::steady_clock::now()); }
+
+            RunLoop& loop;
+        };
+
+        return Awaiter { *this };
+    }
+
+    /// Returns an awaitable that resumes the awaiting coroutine inside run() after delay,
+    /// or as soon as stop is requested on stopToken. The awaiting coroutine must be running
+    /// inside run(), as co_retry's is.
+    auto scheduleAfter (std::chrono::milliseconds delay, stop_token stopToken = stop_token{}) noexcept
+    {
+        struct Expedite
+        {
+            void operator()() const     { loop.expedite (timer); }
+
+            RunLoop& loop;
+            Timer timer;
+        };
+
+        struct Awaiter
+        {
+            bool await_ready() const noexcept  { return stopToken.stop_requested(); }
+            void await_resume() noexcept       { onStop.reset(); }
+
+            void await_suspend (std::coroutine_handle<> handle)
+            {
+                auto timer = loop.post (handle, std::chrono::steady_clock::now() + delay);
+
+                // run() cannot resume the coroutine before this returns, as it is the thread running it
+                if (stopToken.stop_possible())
+                {
+                    onStop.emplace (stopToken, Expedite { loop, timer });
+                }
+            }
+
+            RunLoop& loop;
+            std::chrono::milliseconds delay;
+            stop_token stopToken;
+            std::optional<stop_callback<Expedite>> onStop;
+        };
+
+        return Awaiter { *this, delay, std::move (stopToken), std::nullopt };
+    }
+
+    /// Resumes scheduled coroutines on the calling thread until stop() is called
+    void run()
+    {
+        std::unique_lock lock (mutex);
+
+        while (! stopped)
+        {
+            if (timers.empty())
+            {
+                wakeup.wait (lock);
+                continue;
+            }
+
+            auto next = *timers.begin();
+            if (next.deadline > std::chrono::steady_clock::now())
+            {
+                wakeup.wait_until (lock, next.deadline);
+                continue;
+            }
+
+            timers.erase (timers.begin());
+            lock.unlock();
+            next.handle.resume();
+            lock.lock();
+        }
+
+        stopped = false;
+    }
+
+    /// Makes run() return once the coroutine it is currently resuming suspends
+    void stop()
+    {
+        {
+            std::lock_guard lock (mutex);
+            stopped = true;
+        }
+
+        wakeup.notify_all();
+    }
+
+private:
+    struct Timer
+    {
+        std::chrono::steady_clock::time_point deadline;
+        std::uint64_t sequence;
+        std::coroutine_handle<> handle;
+
+        bool operator< (const Timer& other) const noexcept
+        {
+            return deadline != other.deadline ? deadline < other.deadline : sequence < other.sequence;
+        }
+    };
+
+    Timer post (std::coroutine_handle<> handle, std::chrono::steady_clock::time_point deadline)
+    {
+        Timer timer;
+
+        {
+            std::lock_guard lock (mutex);
+            timer = { deadline, nextSequence++, handle };
+            timers.insert (timer);
+        }
+
+        wakeup.notify_one();
+        return timer;
+    }
+
+    /// Makes a timer due now, unless it has already been resumed
+    void expedite (const Timer& timer)
+    {
+        {
+            std::lock_guard lock (mutex);
+            if (timers.erase (timer) == 0)
+            {
+                return;
+            }
+
+            timers.insert ({ std::chrono::steady_clock::time_point::min(), timer.sequence, timer.handle });
+        }
+
+        wakeup.notify_one();
+    }
+
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::set<Timer> timers;
+    std::uint64_t nextSequence = 0;
+    bool stopped = false;
+};
+
+} // namespace retryxx
+
+namespace retryxx::detail
+{
+
+template <typename T>
+decltype (auto) getAwaiter (T&& awaitable)
+{
+    if constexpr (requires { std::forward<T> (awaitable).operator co_await(); })
+    {
+        return std::forward<T> (awaitable).operator co_await();
+    }
+    else if constexpr (requires { operator co_await (std::forward<T> (awaitable)); })
+    {
+        return operator co_await (std::forward<T> (awaitable));
+    }
+    else
+    {
+        return std::forward<T> (awaitable);
+    }
+}
+
+/// The type produced by co_await on a value of type T
+template <typename T>
+using AwaitResult = decltype (getAwaiter (std::declval<T>()).await_resume());
+
+/// Fire-and-forget coroutine used by spawn()
+struct DetachedTask
+{
+    struct promise_type
+    {
+        DetachedTask get_return_object() noexcept      { return {}; }
+        std::suspend_never initial_suspend() noexcept  { return {}; }
+        std::suspend_never final_suspend() noexcept    { return {}; }
+        void return_void() noexcept                    {}
+        void unhandled_exception() noexcept            { std::terminate(); }
+    };
+};
+
+} // namespace detail
+
+namespace retryxx
+{
+
+/// Starts a task without awaiting it and passes its result to onComplete.
+/// This is the bridge from plain code into co_retry, e.g. from an Asio completion
+/// handler or before entering RunLoop::run().
+template <typename T, typename Callback>
+detail::DetachedTask spawn (Task<T> task, Callback onComplete)
+{
+    onComplete (co_await std::move (task));
+}
+
+/// Coroutine counterpart of retry() for callables returning an awaitable.
+/// The attempts and the backoff between them never block a thread: each backoff is
+/// a co_await on the executor's timer and the coroutine resumes on the executor.
+/// @param executor                         Executor to resume on, must outlive the retry
+/// @param func                             Callable returning an awaitable for one attempt, optionally taking a stop_token
+/// @param shouldRetryPredicate             Determines if result should trigger a retry
+/// @param shouldRetryExceptionPredicate    Determines if exception should trigger a retry
+/// @param maxAttempts                      Maximum number of retry attempts
+/// @param backoffPolicy                    Timing configuration for retries
+/// @param stopToken                        Token for cooperative cancellation, ends a pending backoff immediately if the executor's scheduleAfter() takes one
+/// @param options                          Optional shared collaborators such as a RetryBudget
+/// @returns                                Task producing the expected that retry() would have returned
+template <CoroutineExecutor Executor, typename F,
+          typename ShouldRetryPredicate,
+          typename ShouldRetryExceptionPredicate,
+          BackoffStrategy Policy = BackoffPolicy,
+          typename ResultType = std::remove_cvref_t<detail::AwaitResult<detail::AttemptResult<F>>>,
+          typename Observer = NoObserver>
+Task<expected<ResultType, RetryError>> co_retry (Executor& executor,
+                                                 F func,
+                                                 ShouldRetryPredicate shouldRetryPredicate,
+                                                 ShouldRetryExceptionPredicate shouldRetryExceptionPredicate,
+                                                 int maxAttempts = 5,
+                                                 Policy backoffPolicy = Policy{},
+                                                 stop_token stopToken = stop_token{},
+                                                 BasicRetryOptions<Observer> options = {})
+{
+    detail::RetryLoop<ResultType, ShouldRetryPredicate&, ShouldRetryExceptionPredicate&, Policy, Observer> loop (
+        shouldRetryPredicate,
+        shouldRetryExceptionPredicate,
+        maxAttempts,
+        std::move (backoffPolicy),
+        options);
+
+    co_await executor.schedule();
+
+    while (loop.beginAttempt())
+    {
+#if RETRYXX_EXCEPTIONS
+        try
+#endif
+        {
+            // The timeout has to outlive the awaitable, so it lives in the coroutine frame
+            std::optional<detail::AttemptTimeout> attemptTimeout;
+
+            if (StopTokenAware<F> && options.attemptTimeout > options.attemptTimeout.zero())
+            {
+                attemptTimeout.emplace (stopToken, options.attemptTimeout);
+            }
+
+            // Named, as GCC 12 releases a temporary token in the co_await expression twice
+            auto attemptToken = attemptTimeout ? attemptTimeout->getToken() : stopToken;
+            ResultType result = co_await detail::invokeAttempt (func, attemptToken);
+            if (loop.onResult (std::move (result)))
+            {
+                break;
+            }
+        }
+#if RETRYXX_EXCEPTIONS
+        catch (const detail::HandledException<ShouldRetryExceptionPredicate>& e)
+        {
+            if (loop.onException (e))
+            {
+                break;
+            }
+        }
+#endif
+
+        if constexpr (requires { executor.scheduleAfter (std::chrono::milliseconds(), stopToken); })
+        {
+            co_await executor.scheduleAfter (loop.nextDelay(), stopToken);
+        }
+        else
+        {
+            co_await executor.scheduleAfter (loop.nextDelay());
+        }
+
+        if (stopToken.stop_requested())
+        {
+            loop.cancel();
+            break;
+        }
+    }
+
+    co_return loop.takeResult();
+}
+
+} // namespace retryxx
@@ -0,0 +1,304 @@
+//
+//  retryxx_executor.h
+//  retryxx
+//
+//  MIT License
+//
+//  Copyright (c) 2025 Jacob Sologub
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+#pragma once
+
+#include "retryxx_scheduler.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace retryxx
+{
+
+/// Work-stealing pool for running many retries of ordinary blocking callables without a
+/// thread each. Every worker has its own queue: it takes its newest work first and, when
+/// that is empty, steals the oldest work from the others. A retry waiting out a backoff is
+/// parked in a timer wheel shared by the whole pool and driven by one timer thread, which
+/// hands it back to a worker once it is due, so no worker ever sleeps on behalf of a retry.
+class RetryExecutor
+{
+public:
+    /// Creates an executor and starts its threads.
+    /// @param numWorkers      Number of worker threads running attempts (default: one per hardware thread)
+    /// @param tickInterval    Timer resolution, backoffs are rounded up to a whole tick (default: 1 ms)
+    explicit RetryExecutor (int numWorkers = static_cast<int> (std::thread::hardware_concurrency()),
+                            std::chrono::milliseconds tickInterval = std::chrono::milliseconds (1))
+      : numWorkers (static_cast<std::size_t> (std::max (numWorkers, 1))),
+        workers (std::make_unique<Worker[]> (this->numWorkers)),
+        timers (tickInterval)
+    {
+        for (std::size_t i = 0; i < this->numWorkers; ++i)
+        {
+            threads.emplace_back ([this, i] { runWorker (i); });
+        }
+
+        threads.emplace_back ([this] { runTimers(); });
+    }
+
+    /// Stops the threads. Retries that are still queued or backing off complete as cancelled.
+    ~RetryExecutor()
+    {
+        {
+            std::scoped_lock lock (idleMutex, timerMutex);
+            stopping = true;
+        }
+
+        idle.notify_all();
+        timerWakeup.notify_all();
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        detail::TimerList remaining;
+        timers.drain (remaining);
+
+        for (std::size_t i = 0; i < numWorkers; ++i)
+        {
+            remaining.splice (workers[i].queue);
+        }
+
+        while (auto* node = remaining.popFront())
+        {
+            node->abandon();
+        }
+    }
+
+    RetryExecutor (const RetryExecutor&) = delete;
+    RetryExecutor& operator= (const RetryExecutor&) = delete;
+
+    /// Runs func with retry logic on the pool.
+    /// @param func                             The function to execute and potentially retry, optionally taking a stop_token
+    /// @param shouldRetryPredicate             Determines if result should trigger a retry, as a bool or a RetryDecision
+    /// @param shouldRetryExceptionPredicate    Determines if exception should trigger a retry
+    /// @param maxAttempts                      Maximum number of retry attempts
+    /// @param backoffPolicy                    Timing configuration for retries
+    /// @param stopToken                        Token for cooperative cancellation, ends a pending backoff immediately
+    /// @param options                          Optional shared collaborators such as a RetryBudget
+    /// @returns                                Future of the expected that retry() would have returned
+    template <Retryable F, typename ShouldRetryPredicate,
+                           typename ShouldRetryExceptionPredicate,
+                           BackoffStrategy Policy = BackoffPolicy,
+                           typename ResultType = detail::AttemptResult<std::decay_t<F>>,
+                           typename Observer = NoObserver>
+    std::future<expected<ResultType, RetryError>> submit (F&& func,
+                                                          ShouldRetryPredicate&& shouldRetryPredicate,
+                                                          ShouldRetryExceptionPredicate&& shouldRetryExceptionPredicate,
+                                                          int maxAttempts = 5,
+                                                          Policy backoffPolicy = Policy{},
+                                                          stop_token stopToken = stop_token{},
+                                                          const BasicRetryOptions<Observer>& options = {})
+    {
+        using Loop = detail::RetryLoop<ResultType,
+                                       std::decay_t<ShouldRetryPredicate>,
+                                       std::decay_t<ShouldRetryExceptionPredicate>,
+                                       Policy,
+                                       Observer>;
+
+        auto* operation = new detail::AsyncRetryOperation<std::decay_t<F>, Loop, RetryExecutor> (
+            *this,
+            std::forward<F> (func),
+            Loop (std::forward<ShouldRetryPredicate> (shouldRetryPredicate),
+                  std::forward<ShouldRetryExceptionPredicate> (shouldRetryExceptionPredicate),
+                  maxAttempts,
+                  std::move (backoffPolicy),
+                  options),
+            std::move (stopToken));
+
+        auto future = operation->getFuture();
+        post (*operation);
+        return future;
+    }
+
+    /// Returns the number of retries currently waiting out a backoff
+    std::size_t pending() const
+    {
+        std::lock_guard lock (timerMutex);
+        return timers.size();
+    }
+
+    /// Queues node to run on a worker, the calling worker's own queue if called from one.
+    /// Low-level hook used by submit(), the node must stay alive until run() or abandon().
+    void post (detail::TimerNode& node)
+    {
+        auto index = currentExecutor == this ? currentWorker
+                                             : nextWorker.fetch_add (1, std::memory_order_relaxed) % numWorkers;
+
+        {
+            std::lock_guard lock (workers[index].mutex);
+            workers[index].queue.pushBack (&node);
+        }
+
+        queued.fetch_add (1);
+
+        if (sleeping.load() > 0)
+        {
+            std::lock_guard lock (idleMutex);
+            idle.notify_one();
+        }
+    }
+
+    /// Parks node in the timer wheel until delay has elapsed, or queues it straight away
+    /// if stop has been requested on stopToken.
+    /// Low-level hook used by submit(), the node must stay alive until run() or abandon().
+    void postAfter (detail::TimerNode& node, std::chrono::milliseconds delay, const stop_token& stopToken = stop_token{})
+    {
+        {
+            std::lock_guard lock (timerMutex);
+
+            if (! stopToken.stop_requested())
+            {
+                timers.add (&node, delay);
+                timerWakeup.notify_one();
+                return;
+            }
+        }
+
+        post (node);
+    }
+
+    /// Moves node from the timer wheel to a worker so it runs without waiting for its
+    /// deadline. Does nothing if the node is not waiting in the wheel.
+    void expedite (detail::TimerNode& node)
+    {
+        {
+            std::lock_guard lock (timerMutex);
+            if (! timers.remove (&node))
+            {
+                return;
+            }
+        }
+
+        post (node);
+    }
+
+private:
+    struct alignas (64) Worker
+    {
+        std::mutex mutex;
+        detail::TimerList queue;
+    };
+
+    void runWorker (std::size_t index)
+    {
+        currentExecutor = this;
+        currentWorker = index;
+
+        while (! stopping)
+        {
+            if (auto* node = takeWork (index))
+            {
+                node->run();
+                continue;
+            }
+
+            std::unique_lock lock (idleMutex);
+            sleeping.fetch_add (1);
+            idle.wait (lock, [this] { return queued.load() > 0 || stopping; });
+            sleeping.fetch_sub (1);
+        }
+
+        currentExecutor = nullptr;
+    }
+
+    /// Pops the newest node from the worker's own queue, or steals the oldest from another
+    detail::TimerNode* takeWork (std::size_t index)
+    {
+        for (std::size_t i = 0; i < numWorkers; ++i)
+        {
+            auto& worker = workers[(index + i) % numWorkers];
+            std::lock_guard lock (worker.mutex);
+
+            if (auto* node = i == 0 ? worker.queue.popBack() : worker.queue.popFront())
+            {
+                queued.fetch_sub (1);
+                return node;
+            }
+        }
+
+        return nullptr;
+    }
+
+    void runTimers()
+    {
+        std::unique_lock lock (timerMutex);
+
+        while (! stopping)
+        {
+            detail::TimerList due;
+            timers.advance (due);
+
+            if (! due.empty())
+            {
+                lock.unlock();
+
+                while (auto* node = due.popFront())
+                {
+                    post (*node);
+                }
+
+                lock.lock();
+                continue;
+            }
+
+            if (auto next = timers.nextExpiry())
+            {
+                timerWakeup.wait_until (lock, *next);
+            }
+            else
+            {
+                timerWakeup.wait (lock);
+            }
+        }
+    }
+
+    static inline thread_local const RetryExecutor* currentExecutor = nullptr;
+    static inline thread_local std::size_t currentWorker = 0;
+
+    const std::size_t numWorkers;
+    std::unique_ptr<Worker[]> workers;
+    std::atomic<std::size_t> nextWorker { 0 };
+    std::atomic<std::size_t> queued { 0 };
+    std::atomic<int> sleeping { 0 };
+    std::atomic<bool> stopping { false };
+    std::mutex idleMutex;
+    std::condition_variable idle;
+
+    mutable std::mutex timerMutex;
+    std::condition_variable timerWakeup;
+    detail::TimerQueue timers;
+
+    std::vector<std::thread> threads;
+};
+
+} // namespace retryxx
@@ -0,0 +1,437 @@
+//
+//  retryxx_hedge.h
+//  retryxx
+//
+//  MIT License
+//
+//  Copyright (c) 2025 Jacob Sologub
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+#pragma once
+
+#include "retryxx_scheduler.h"
+
+#include <bit>
+#include <memory>
+#include <utility>
+
+namespace retryxx
+{
+
+/// Lock-free latency histogram used to derive hedge delays from observed percentiles.
+/// Latencies are bucketed at microsecond resolution with four buckets per power of two,
+/// so a percentile is accurate to within 25%.
+class LatencyTracker
+{
+public:
+    LatencyTracker() = default;
+    LatencyTracker (const LatencyTracker&) = delete;
+    LatencyTracker& operator= (const LatencyTracker&) = delete;
+
+    /// Records one observed latency
+    void record (std::chrono::nanoseconds latency) noexcept
+    {
+        auto micros = static_cast<std::uint64_t> (std::max<std::int64_t> (std::chrono::duration_cast<std::chrono::microseconds> (latency).count(), 0));
+        buckets[bucketFor (micros)].fetch_add (1, std::memory_order_relaxed);
+    }
+
+    /// Returns the number of latencies recorded so far
+    std::uint64_t count() const noexcept
+    {
+        std::uint64_t total = 0;
+        for (const auto& bucket : buckets)
+        {
+            total += bucket.load (std::memory_order_relaxed);
+        }
+
+        return total;
+    }
+
+    /// Returns the latency below which the given fraction of recorded latencies fall.
+    /// @param fraction    Percentile as a fraction, e.g. 0.95 for p95
+    std::chrono::milliseconds percentile (double fraction) const noexcept
+    {
+        auto total = count();
+        if (total == 0)
+        {
+            return std::chrono::milliseconds (0);
+        }
+
+        auto target = static_cast<std::uint64_t> (std::ceil (std::clamp (fraction, 0.0, 1.0) * static_cast<double> (total)));
+        std::uint64_t seen = 0;
+
+        for (std::size_t i = 0; i < numBuckets; ++i)
+        {
+            seen += buckets[i].load (std::memory_order_relaxed);
+            if (seen >= std::max<std::uint64_t> (target, 1))
+            {
+                return std::chrono::ceil<std::chrono::milliseconds> (std::chrono::microseconds (upperBound (i)));
+            }
+        }
+
+        return std::chrono::ceil<std::chrono::milliseconds> (std::chrono::microseconds (upperBound (numBuckets - 1)));
+    }
+
+private:
+    static constexpr std::size_t subBuckets = 4;
+    static constexpr std::size_t numBuckets = 40 * subBuckets;
+
+    static std::size_t bucketFor (std::uint64_t micros) noexcept
+    {
+        if (micros < subBuckets)
+        {
+            return static_cast<std::size_t> (micros);
+        }
+
+        auto msb = static_cast<std::size_t> (std::bit_width (micros)) - 1;
+        auto sub = static_cast<std::size_t> (micros >> (msb - 2)) & (subBuckets - 1);
+        return std::min ((msb - 1) * subBuckets + sub, numBuckets - 1);
+    }
+
+    static std::uint64_t upperBound (std::size_t bucket) noexcept
+    {
+        if (bucket < subBuckets)
+        {
+            return bucket;
+        }
+
+        auto msb = bucket / subBuckets + 1;
+        auto lower = static_cast<std::uint64_t> (subBuckets + bucket % subBuckets) << (msb - 2);
+        return lower + (std::uint64_t (1) << (msb - 2)) - 1;
+    }
+
+    std::array<std::atomic<std::uint64_t>, numBuckets> buckets {};
+};
+
+/// Configures when hedge() launches speculative attempts.
+struct HedgePolicy
+{
+    /// Delay before each further attempt is launched, used until the tracker has enough samples
+    std::chrono::milliseconds delay = std::chrono::milliseconds (50);
+
+    /// Number of attempts launched in addition to the first
+    int maxHedges = 1;
+
+    /// When set, the delay is this tracker's latency at the given percentile, and every
+    /// winning attempt's latency is recorded into it
+    LatencyTracker* latencyTracker = nullptr;
+
+    /// Percentile of observed latency to hedge at, as a fraction
+    double percentile = 0.95;
+
+    /// Samples the tracker needs before its percentile replaces the fixed delay
+    std::uint64_t minimumSamples = 20;
+
+    /// Shortest delay getDelay() returns, so that a tracker which has only seen very fast
+    /// calls does not launch every hedge at once
+    std::chrono::milliseconds minimumDelay = std::chrono::milliseconds (1);
+
+    /// Returns the delay to wait before launching each further attempt
+    std::chrono::milliseconds getDelay() const noexcept
+    {
+        if (latencyTracker != nullptr && latencyTracker->count() >= minimumSamples)
+        {
+            return std::max (latencyTracker->percentile (percentile), minimumDelay);
+        }
+
+        return std::max (delay, minimumDelay);
+    }
+};
+
+} // namespace retryxx
+
+namespace retryxx::detail
+{
+
+/// State shared by the caller of hedge() and every attempt it launched. Attempts that
+/// lose the race may still be running when hedge() returns, so they co-own it.
+template <typename F, typename ShouldRetryPredicate, typename ShouldRetryExceptionPredicate>
+class HedgeState
+{
+public:
+    using ResultType = AttemptResult<F>;
+    using Result = expected<ResultType, RetryError>;
+
+    HedgeState (RetryScheduler& scheduler,
+                F func,
+                ShouldRetryPredicate shouldRetry,
+                ShouldRetryExceptionPredicate shouldRetryException,
+                int totalAttempts,
+                LatencyTracker* tracker)
+      : scheduler (scheduler),
+        func (std::move (func)),
+        shouldRetryPredicate (std::move (shouldRetry)),
+        shouldRetryExceptionPredicate (std::move (shouldRetryException)),
+        latencyTracker (tracker),
+        pending (static_cast<std::size_t> (totalAttempts), nullptr)
+    {
+    }
+
+    void setPending (std::size_t index, TimerNode* node)  { pending[index] = node; }
+
+    void runAttempt (std::size_t index)
+    {
+        {
+            std::lock_guard lock (mutex);
+            pending[index] = nullptr;
+
+            if (result.has_value())
+            {
+                ++finished;
+                return;
+            }
+
+            ++launched;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::optional<ResultType> value;
+        std::exception_ptr exception;
+        auto retryable = true;
+
+#if RETRYXX_EXCEPTIONS
+        try
+#endif
+        {
+            value.emplace (invokeAttempt (func, stopSource.get_token()));
+            retryable = RetryDecision (shouldRetryPredicate (*value)).shouldRetry();
+        }
+#if RETRYXX_EXCEPTIONS
+        catch (const HandledException<ShouldRetryExceptionPredicate>& e)
+        {
+            exception = std::current_exception();
+            retryable = RetryDecision (shouldRetryExceptionPredicate (e)).shouldRetry();
+        }
+#endif
+
+        std::unique_lock lock (mutex);
+        ++finished;
+
+        if (result.has_value())
+        {
+            return;
+        }
+
+        if (! retryable)
+        {
+            if (value.has_value())
+            {
+                if (latencyTracker != nullptr)
+                {
+                    latencyTracker->record (std::chrono::steady_clock::now() - start);
+                }
+
+                result.emplace (std::move (*value));
+            }
+            else
+            {
+                result.emplace (unexpected (RetryError { RetryErrorReason::nonRetryableException, launched, exception }));
+            }
+
+            return finish (lock);
+        }
+
+        if (finished == pending.size())
+        {
+            result.emplace (unexpected (RetryError { RetryErrorReason::exhausted, launched, exception }));
+            return finish (lock);
+        }
+
+        // A failed attempt launches the next hedge still waiting in the wheel straight away,
+        // passing over any that are already due and about to run
+        for (auto* node : pending)
+        {
+            if (node != nullptr && scheduler.expedite (*node))
+            {
+                break;
+            }
+        }
+    }
+
+    void abandonAttempt (std::size_t index)
+    {
+        std::unique_lock lock (mutex);
+        pending[index] = nullptr;
+
+        if (++finished == pending.size() && ! result.has_value())
+        {
+            result.emplace (unexpected (RetryError { RetryErrorReason::cancelled, launched, nullptr }));
+            finish (lock);
+        }
+    }
+
+    void cancel()
+    {
+        std::unique_lock lock (mutex);
+        if (! result.has_value())
+        {
+            result.emplace (unexpected (RetryError { RetryErrorReason::cancelled, launched, nullptr }));
+            finish (lock);
+        }
+    }
+
+    Result wait()
+    {
+        std::unique_lock lock (mutex);
+        completed.wait (lock, [this] { return result.has_value(); });
+        return std::move (*result);
+    }
+
+private:
+    /// Wakes the caller, takes the attempts that have not started out of the scheduler and
+    /// stops the ones that lost
+    void finish (std::unique_lock<std::mutex>& lock)
+    {
+        std::vector<TimerNode*> unstarted;
+
+        for (auto& node : pending)
+        {
+            // A node that is no longer in the wheel is about to run and will find the result
+            if (node != nullptr && scheduler.cancel (*node))
+            {
+                unstarted.push_back (std::exchange (node, nullptr));
+                ++finished;
+            }
+        }
+
+        lock.unlock();
+        completed.notify_all();
+        stopSource.request_stop();
+
+        for (auto* node : unstarted)
+        {
+            delete node;
+        }
+    }
+
+    RetryScheduler& scheduler;
+    F func;
+    ShouldRetryPredicate shouldRetryPredicate;
+    ShouldRetryExceptionPredicate shouldRetryExceptionPredicate;
+    LatencyTracker* latencyTracker;
+
+    std::mutex mutex;
+    std::condition_variable completed;
+    std::vector<TimerNode*> pending;
+    std::size_t finished = 0;
+    int launched = 0;
+    std::optional<Result> result;
+    stop_source stopSource;
+};
+
+/// One hedged attempt queued on the scheduler.
+template <typename State>
+class HedgeAttempt final : public TimerNode
+{
+public:
+    HedgeAttempt (std::shared_ptr<State> hedgeState, std::size_t attemptIndex)
+      : state (std::move (hedgeState)), index (attemptIndex)
+    {
+    }
+
+    void run() override
+    {
+        state->runAttempt (index);
+        delete this;
+    }
+
+    void abandon() override
+    {
+        state->abandonAttempt (index);
+        delete this;
+    }
+
+private:
+    std::shared_ptr<State> state;
+    std::size_t index;
+};
+
+} // namespace detail
+
+namespace retryxx
+{
+
+/// Executes a function with hedging: if an attempt has not completed within the hedge
+/// delay, another one is launched concurrently on the scheduler, up to maxHedges extra.
+/// The first acceptable result wins and the attempts still running are asked to stop
+/// through the stop token they were given. An attempt that fails launches the next
+/// hedge straight away. The calling thread blocks until there is an outcome.
+///
+/// Attempts run concurrently on the scheduler's threads, so it needs more threads than
+/// maxHedges or a slow attempt would hold up the hedge meant to overtake it. With too few,
+/// hedge() makes no attempt and returns RetryErrorReason::invalidArgument. func and the
+/// predicates must be safe to call from several threads at once. func may take a stop_token, which is how losing attempts
+/// learn that they can give up.
+/// @param scheduler                        Scheduler that runs the attempts
+/// @param func                             The function to execute, optionally taking a stop_token
+/// @param shouldRetryPredicate             Determines if result should trigger another attempt
+/// @param shouldRetryExceptionPredicate    Determines if exception should trigger another attempt
+/// @param hedgePolicy                      When to launch further attempts
+/// @param stopToken                        Token for cooperative cancellation of the whole operation
+/// @returns                                Expected containing either the winning result or a RetryError
+template <typename F, typename ShouldRetryPredicate,
+                      typename ShouldRetryExceptionPredicate,
+                      typename ResultType = detail::AttemptResult<std::decay_t<F>>>
+expected<ResultType, RetryError> hedge (RetryScheduler& scheduler,
+                                        F&& func,
+                                        ShouldRetryPredicate&& shouldRetryPredicate,
+                                        ShouldRetryExceptionPredicate&& shouldRetryExceptionPredicate,
+                                        HedgePolicy hedgePolicy = HedgePolicy{},
+                                        stop_token stopToken = stop_token{})
+{
+    using State = detail::HedgeState<std::decay_t<F>,
+                                     std::decay_t<ShouldRetryPredicate>,
+                                     std::decay_t<ShouldRetryExceptionPredicate>>;
+
+    auto totalAttempts = std::max (hedgePolicy.maxHedges, 0) + 1;
+
+    if (scheduler.getNumThreads() < totalAttempts)
+    {
+        return unexpected (RetryError { RetryErrorReason::invalidArgument, 0, nullptr });
+    }
+
+    auto state = std::make_shared<State> (scheduler,
+                                          std::forward<F> (func),
+                                          std::forward<ShouldRetryPredicate> (shouldRetryPredicate),
+                                          std::forward<ShouldRetryExceptionPredicate> (shouldRetryExceptionPredicate),
+                                          totalAttempts,
+                                          hedgePolicy.latencyTracker);
+
+    std::vector<detail::HedgeAttempt<State>*> attempts;
+    for (int i = 0; i < totalAttempts; ++i)
+    {
+        attempts.push_back (new detail::HedgeAttempt<State> (state, static_cast<std::size_t> (i)));
+        state->setPending (static_cast<std::size_t> (i), attempts.back());
+    }
+
+    auto delay = hedgePolicy.getDelay();
+    for (int i = 0; i < totalAttempts; ++i)
+    {
+        scheduler.postAfter (*attempts[static_cast<std::size_t> (i)], delay * i);
+    }
+
+    auto onStop = [&state] { state->cancel(); };
+    stop_callback<decltype (onStop)> callback (stopToken, onStop);
+
+    return state->wait();
+}
+
+} // namespace retryxx
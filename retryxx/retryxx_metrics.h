@@ -0,0 +1,243 @@
+//
+//  retryxx_metrics.h
+//  retryxx
+//
+//  MIT License
+//
+//  Copyright (c) 2025 Jacob Sologub
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+#pragma once
+
+#include "retryxx_retry.h"
+
+#include <ostream>
+#include <string_view>
+
+namespace retryxx
+{
+
+/// Lock-free retry counters and a backoff histogram, usable as the observer of any
+/// number of concurrent retries: pass BasicRetryOptions<RetryMetrics*> { .observer = &metrics }.
+/// Every callback is a few relaxed increments on the calling thread's cache-line sized
+/// shard, so instrumented retries do not contend with each other. snapshot() sums the
+/// shards, and writePrometheus() prints them in the Prometheus text exposition format.
+class RetryMetrics
+{
+public:
+    /// Upper bound of the last finite backoff histogram bucket is 2^(numBackoffBuckets - 2) ms
+    static constexpr std::size_t numBackoffBuckets = 18;
+    static constexpr std::size_t numReasons = static_cast<std::size_t> (RetryErrorReason::invalidArgument) + 1;
+
+    /// Totals since the metrics were created
+    struct Snapshot
+    {
+        std::uint64_t calls = 0;                                    ///< Retry operations started
+        std::uint64_t attempts = 0;                                 ///< Attempts made, including first ones
+        std::uint64_t retries = 0;                                  ///< Attempts made after the first one
+        std::uint64_t successes = 0;                                ///< Retry operations that returned a result
+        std::uint64_t backoffs = 0;                                 ///< Waits between attempts
+        std::uint64_t backoffMilliseconds = 0;                      ///< Total time spent waiting between attempts
+        std::array<std::uint64_t, numReasons> giveUps {};           ///< Failed retry operations, by RetryErrorReason
+        std::array<std::uint64_t, numBackoffBuckets> backoffBuckets {}; ///< Backoffs by delay, bucket i up to 2^i ms
+    };
+
+    RetryMetrics() = default;
+    RetryMetrics (const RetryMetrics&) = delete;
+    RetryMetrics& operator= (const RetryMetrics&) = delete;
+
+    void onAttempt (int attempt) noexcept
+    {
+        bump (attempt == 1 ? localShard().firstAttempts : localShard().retries);
+    }
+
+    void onBackoff (int, std::chrono::milliseconds delay) noexcept
+    {
+        auto& shard = localShard();
+        bump (shard.backoffs);
+        bump (shard.backoffMilliseconds, static_cast<std::uint64_t> (std::max<long long> (delay.count(), 0)));
+        bump (shard.backoffBuckets[bucketFor (delay)]);
+    }
+
+    void onSuccess (int) noexcept
+    {
+        bump (localShard().successes);
+    }
+
+    void onGiveUp (const RetryError& error) noexcept
+    {
+        auto reason = std::min (static_cast<std::size_t> (error.reason), numReasons - 1);
+        auto& shard = localShard();
+        bump (shard.giveUps[reason]);
+
+        // A retry refused before its first attempt, e.g. by an open breaker, is still a call
+        if (error.attempts == 0)
+        {
+            bump (shard.callsWithoutAttempts);
+        }
+    }
+
+    /// Returns the totals across every thread. Counters are read one at a time, so a
+    /// snapshot taken while retries run may be off by the few updates in flight.
+    Snapshot snapshot() const noexcept
+    {
+        Snapshot total;
+
+        for (const auto& shard : shards)
+        {
+            auto firstAttempts = shard.firstAttempts.load (std::memory_order_relaxed);
+            total.calls += firstAttempts + shard.callsWithoutAttempts.load (std::memory_order_relaxed);
+            total.attempts += firstAttempts;
+            total.retries += shard.retries.load (std::memory_order_relaxed);
+            total.successes += shard.successes.load (std::memory_order_relaxed);
+            total.backoffs += shard.backoffs.load (std::memory_order_relaxed);
+            total.backoffMilliseconds += shard.backoffMilliseconds.load (std::memory_order_relaxed);
+
+            for (std::size_t i = 0; i < numReasons; ++i)
+            {
+                total.giveUps[i] += shard.giveUps[i].load (std::memory_order_relaxed);
+            }
+
+            for (std::size_t i = 0; i < numBackoffBuckets; ++i)
+            {
+                total.backoffBuckets[i] += shard.backoffBuckets[i].load (std::memory_order_relaxed);
+            }
+        }
+
+        total.attempts += total.retries;
+        return total;
+    }
+
+    /// Writes the metrics in the Prometheus text exposition format.
+    /// @param stream   Stream to write to
+    /// @param prefix   Prefix of every metric name
+    template <typename CharT, typename Traits>
+    void writePrometheus (std::basic_ostream<CharT, Traits>& stream, std::string_view prefix = "retryxx") const
+    {
+        auto totals = snapshot();
+
+        auto counter = [&] (std::string_view name, std::string_view help, std::uint64_t value)
+        {
+            stream << "# HELP " << prefix << '_' << name << ' ' << help << '\n'
+                   << "# TYPE " << prefix << '_' << name << " counter\n"
+                   << prefix << '_' << name << ' ' << value << '\n';
+        };
+
+        counter ("calls_total", "Retry operations started.", totals.calls);
+        counter ("attempts_total", "Attempts made, including first attempts.", totals.attempts);
+        counter ("retries_total", "Attempts made after the first attempt.", totals.retries);
+        counter ("successes_total", "Retry operations that returned an accepted result.", totals.successes);
+
+        stream << "# HELP " << prefix << "_give_ups_total Retry operations that failed, by reason.\n"
+               << "# TYPE " << prefix << "_give_ups_total counter\n";
+
+        for (std::size_t i = 0; i < numReasons; ++i)
+        {
+            stream << prefix << "_give_ups_total{reason=\"" << reasonName (static_cast<RetryErrorReason> (i)) << "\"} "
+                   << totals.giveUps[i] << '\n';
+        }
+
+        stream << "# HELP " << prefix << "_backoff_seconds Time waited between attempts.\n"
+               << "# TYPE " << prefix << "_backoff_seconds histogram\n";
+
+        std::uint64_t cumulative = 0;
+
+        for (std::size_t i = 0; i < numBackoffBuckets; ++i)
+        {
+            cumulative += totals.backoffBuckets[i];
+            stream << prefix << "_backoff_seconds_bucket{le=\"";
+
+            if (i + 1 < numBackoffBuckets)
+            {
+                stream << static_cast<double> (std::uint64_t (1) << i) / 1000.0;
+            }
+            else
+            {
+                stream << "+Inf";
+            }
+
+            stream << "\"} " << cumulative << '\n';
+        }
+
+        stream << prefix << "_backoff_seconds_sum " << static_cast<double> (totals.backoffMilliseconds) / 1000.0 << '\n'
+               << prefix << "_backoff_seconds_count " << totals.backoffs << '\n';
+    }
+
+private:
+    static constexpr std::size_t numShards = 16;
+
+    struct alignas (64) Shard
+    {
+        std::atomic<std::uint64_t> firstAttempts { 0 };
+        std::atomic<std::uint64_t> callsWithoutAttempts { 0 };
+        std::atomic<std::uint64_t> retries { 0 };
+        std::atomic<std::uint64_t> successes { 0 };
+        std::atomic<std::uint64_t> backoffs { 0 };
+        std::atomic<std::uint64_t> backoffMilliseconds { 0 };
+        std::array<std::atomic<std::uint64_t>, numReasons> giveUps {};
+        std::array<std::atomic<std::uint64_t>, numBackoffBuckets> backoffBuckets {};
+    };
+
+    static void bump (std::atomic<std::uint64_t>& counter, std::uint64_t amount = 1) noexcept
+    {
+        counter.fetch_add (amount, std::memory_order_relaxed);
+    }
+
+    /// Bucket i holds delays up to 2^i ms, the last one everything longer
+    static std::size_t bucketFor (std::chrono::milliseconds delay) noexcept
+    {
+        std::size_t bucket = 0;
+
+        for (auto bound = 1ll; bound < delay.count() && bucket + 1 < numBackoffBuckets; bound <<= 1)
+        {
+            ++bucket;
+        }
+
+        return bucket;
+    }
+
+    static std::string_view reasonName (RetryErrorReason reason) noexcept
+    {
+        switch (reason)
+        {
+            case RetryErrorReason::exhausted:               return "exhausted";
+            case RetryErrorReason::cancelled:               return "cancelled";
+            case RetryErrorReason::nonRetryableException:   return "non_retryable_exception";
+            case RetryErrorReason::budgetExhausted:         return "budget_exhausted";
+            case RetryErrorReason::circuitOpen:             return "circuit_open";
+            case RetryErrorReason::deadlineExceeded:        return "deadline_exceeded";
+            case RetryErrorReason::invalidArgument:         return "invalid_argument";
+        }
+
+        return "unknown";
+    }
+
+    Shard& localShard() noexcept
+    {
+        static std::atomic<std::size_t> nextThread { 0 };
+        thread_local const auto index = nextThread.fetch_add (1, std::memory_order_relaxed) % numShards;
+        return shards[index];
+    }
+
+    std::array<Shard, numShards> shards;
+};
+
+} // namespace retryxx
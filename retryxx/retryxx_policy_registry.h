@@ -0,0 +1,326 @@
+//
+//  retryxx_policy_registry.h
+//  retryxx
+//
+//  MIT License
+//
+//  Copyright (c) 2025 Jacob Sologub
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+#pragma once
+
+#include "retryxx_retry.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace retryxx
+{
+
+/// The retry settings for one endpoint, as stored in a RetryPolicyRegistry
+template <BackoffStrategy Policy = BackoffPolicy>
+struct EndpointPolicy
+{
+    Policy backoffPolicy {};    ///< Timing configuration for retries
+    int maxAttempts = 5;        ///< Maximum number of retry attempts
+};
+
+/// Maps endpoint IDs to immutable retry settings that can be replaced at runtime.
+///
+/// The settings live in a flat, open-addressing table that is never modified once
+/// published: reload(), set() and erase() build a new table and swap it in. Each thread
+/// caches the table it last read from every registry it uses, so a lookup is a single
+/// atomic load of the registry's generation, a search of the thread's cache by registry and
+/// a probe of the cached table, with no locks and no shared writes. A thread only takes the
+/// publishing lock on its first lookup in a registry, and again on its first after a change.
+///
+/// Value can be any copyable type, e.g. a struct that also carries predicates. An old table
+/// is freed once every thread that read it has looked something up again, or has exited.
+/// Once a registry is destroyed, each thread drops its cached tables on its next lookup in
+/// any registry of the same type, or when it exits.
+template <typename Key,
+          typename Value = EndpointPolicy<>,
+          typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>>
+class RetryPolicyRegistry
+{
+public:
+    /// Creates a registry.
+    /// @param policies         Initial settings by endpoint, later duplicates replace earlier ones
+    /// @param defaultPolicy    Settings returned by get() for endpoints that are not registered
+    explicit RetryPolicyRegistry (std::vector<std::pair<Key, Value>> policies = {}, Value defaultPolicy = Value{})
+      : defaultPolicy (std::move (defaultPolicy)),
+        current (std::make_shared<const Table> (std::move (policies)))
+    {
+    }
+
+    ~RetryPolicyRegistry()
+    {
+        lifetime.reset();
+        destroyedRegistries.fetch_add (1, std::memory_order_release);
+    }
+
+    RetryPolicyRegistry (const RetryPolicyRegistry&) = delete;
+    RetryPolicyRegistry& operator= (const RetryPolicyRegistry&) = delete;
+
+    /// Returns a copy of the settings for key, if registered
+    std::optional<Value> find (const Key& key) const
+    {
+        if (const auto* value = snapshot().find (key))
+        {
+            return *value;
+        }
+
+        return std::nullopt;
+    }
+
+    /// Returns a copy of the settings for key, or the default settings if it is not registered
+    Value get (const Key& key) const
+    {
+        const auto* value = snapshot().find (key);
+        return value != nullptr ? *value : defaultPolicy;
+    }
+
+    /// Returns the number of registered endpoints
+    std::size_t size() const
+    {
+        return snapshot().entries.size();
+    }
+
+    /// Replaces every registered endpoint at once. Callers keep using the previous settings
+    /// until their next lookup, none of them wait for the new table to be built.
+    void reload (std::vector<std::pair<Key, Value>> policies)
+    {
+        std::lock_guard lock (writeMutex);
+        publish (std::make_shared<const Table> (std::move (policies)));
+    }
+
+    /// Registers or replaces the settings for a single endpoint
+    void set (const Key& key, Value value)
+    {
+        std::lock_guard lock (writeMutex);
+
+        auto policies = latest()->entries;
+        policies.emplace_back (key, std::move (value));
+        publish (std::make_shared<const Table> (std::move (policies)));
+    }
+
+    /// Removes the settings for key
+    /// @returns    True if key was registered
+    bool erase (const Key& key)
+    {
+        std::lock_guard lock (writeMutex);
+
+        auto policies = latest()->entries;
+        auto removed = std::erase_if (policies, [&] (const auto& entry) { return KeyEqual{} (entry.first, key); });
+
+        if (removed == 0)
+        {
+            return false;
+        }
+
+        publish (std::make_shared<const Table> (std::move (policies)));
+        return true;
+    }
+
+    /// Executes func with retry logic using the settings registered for key, or the
+    /// default settings if there are none.
+    /// @param key                              Endpoint whose settings to use
+    /// @param func                             The function to execute and potentially retry, optionally taking a stop_token
+    /// @param shouldRetryPredicate             Determines if result should trigger a retry, as a bool or a RetryDecision
+    /// @param shouldRetryExceptionPredicate    Determines if exception should trigger a retry
+    /// @param stopToken                        Token for cooperative cancellation
+    /// @param options                          Optional shared collaborators such as a RetryBudget
+    /// @returns                                Expected containing either the successful result or a RetryError
+    template <Retryable F, typename ShouldRetryPredicate,
+                           typename ShouldRetryExceptionPredicate,
+                           typename ResultType = detail::AttemptResult<F>,
+                           typename Observer = NoObserver,
+                           typename Clock = SteadyClock>
+        requires requires (Value& value) { value.backoffPolicy; { value.maxAttempts } -> std::convertible_to<int>; }
+    expected<ResultType, RetryError> retry (const Key& key,
+                                            F&& func,
+                                            ShouldRetryPredicate&& shouldRetryPredicate,
+                                            ShouldRetryExceptionPredicate&& shouldRetryExceptionPredicate,
+                                            stop_token stopToken = stop_token{},
+                                            const BasicRetryOptions<Observer, Clock>& options = {}) const
+    {
+        auto policy = get (key);
+
+        return retryxx::retry (std::forward<F> (func),
+                               std::forward<ShouldRetryPredicate> (shouldRetryPredicate),
+                               std::forward<ShouldRetryExceptionPredicate> (shouldRetryExceptionPredicate),
+                               static_cast<int> (policy.maxAttempts),
+                               std::move (policy.backoffPolicy),
+                               std::move (stopToken),
+                               options);
+    }
+
+private:
+    /// Immutable open-addressing table with linear probing, kept at most half full
+    struct Table
+    {
+        static constexpr std::uint32_t empty = ~std::uint32_t (0);
+
+        struct Bucket
+        {
+            std::size_t hash = 0;
+            std::uint32_t entry = empty;
+        };
+
+        explicit Table (std::vector<std::pair<Key, Value>> policies)
+        {
+            buckets.resize (std::bit_ceil (std::max<std::size_t> (policies.size() * 2, 8)));
+            entries.reserve (policies.size());
+
+            for (auto& [key, value] : policies)
+            {
+                auto hash = Hash{} (key);
+                auto& bucket = buckets[probe (key, hash)];
+
+                if (bucket.entry != empty)
+                {
+                    entries[bucket.entry].second = std::move (value);
+                    continue;
+                }
+
+                bucket = { hash, static_cast<std::uint32_t> (entries.size()) };
+                entries.emplace_back (std::move (key), std::move (value));
+            }
+        }
+
+        const Value* find (const Key& key) const
+        {
+            const auto& bucket = buckets[probe (key, Hash{} (key))];
+            return bucket.entry != empty ? &entries[bucket.entry].second : nullptr;
+        }
+
+        /// Returns the index of the bucket holding key, or of the empty bucket where it would go
+        std::size_t probe (const Key& key, std::size_t hash) const
+        {
+            auto mask = buckets.size() - 1;
+
+            for (auto index = hash & mask;; index = (index + 1) & mask)
+            {
+                const auto& bucket = buckets[index];
+
+                if (bucket.entry == empty || (bucket.hash == hash && KeyEqual{} (entries[bucket.entry].first, key)))
+                {
+                    return index;
+                }
+            }
+        }
+
+        std::vector<Bucket> buckets;
+        std::vector<std::pair<Key, Value>> entries;
+    };
+
+    struct CachedTable
+    {
+        std::uint64_t registry = 0;
+        std::uint64_t generation = 0;
+        std::shared_ptr<const Table> table;
+        std::weak_ptr<const void> owner;
+    };
+
+    /// The tables a thread has cached, one per registry it has used, sorted by registry ID.
+    /// IDs only grow, so a registry is nearly always appended at the end.
+    struct ReaderCache
+    {
+        std::vector<CachedTable> slots;
+        std::uint64_t destroyedSeen = 0;
+    };
+
+    /// Returns the calling thread's cached table, refreshing it if a newer one was published
+    const Table& snapshot() const
+    {
+        auto latestGeneration = generation.load (std::memory_order_acquire);
+        auto& cache = readerCache;
+
+        if (auto destroyed = destroyedRegistries.load (std::memory_order_acquire); destroyed != cache.destroyedSeen)
+        {
+            releaseDestroyed (cache);
+            cache.destroyedSeen = destroyed;
+        }
+
+        auto slot = std::lower_bound (cache.slots.begin(), cache.slots.end(), id,
+                                      [] (const CachedTable& cached, std::uint64_t registry) { return cached.registry < registry; });
+
+        if (slot == cache.slots.end() || slot->registry != id)
+        {
+            slot = cache.slots.insert (slot, CachedTable { id, 0, nullptr, lifetime });
+        }
+
+        if (slot->generation != latestGeneration)
+        {
+            refresh (*slot);
+        }
+
+        return *slot->table;
+    }
+
+    /// Frees the cached tables of registries that no longer exist
+    static void releaseDestroyed (ReaderCache& cache) noexcept
+    {
+        std::erase_if (cache.slots, [] (const CachedTable& slot) { return slot.owner.expired(); });
+    }
+
+    void refresh (CachedTable& slot) const
+    {
+        std::lock_guard lock (publishMutex);
+        slot.table = current;
+        slot.generation = generation.load (std::memory_order_relaxed);
+    }
+
+    std::shared_ptr<const Table> latest() const
+    {
+        std::lock_guard lock (publishMutex);
+        return current;
+    }
+
+    void publish (std::shared_ptr<const Table> table)
+    {
+        std::lock_guard lock (publishMutex);
+        current = std::move (table);
+        generation.fetch_add (1, std::memory_order_release);
+    }
+
+    static inline std::atomic<std::uint64_t> nextId { 1 };
+    static inline std::atomic<std::uint64_t> destroyedRegistries { 0 };
+    static inline thread_local ReaderCache readerCache;
+
+    const std::uint64_t id = nextId.fetch_add (1, std::memory_order_relaxed);
+    std::shared_ptr<const void> lifetime = std::make_shared<char>();
+    const Value defaultPolicy;
+    std::atomic<std::uint64_t> generation { 1 };
+    mutable std::mutex publishMutex;
+    std::mutex writeMutex;
+    std::shared_ptr<const Table> current;
+};
+
+} // namespace retryxx
@@ -29,14 +29,37 @@
 
 static_assert (__cplusplus >= 202002L, "retryxx requires C++20 or later");
 
+#include <version>
 #include <chrono>
+#include <cstdint>
+#include <limits>
+#include <cmath>
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <random>
 #include <thread>
 #include <functional>
+#include <optional>
+#include <string>
 #include <type_traits>
 #include <concepts>
-#include <format>
+#include <exception>
+#include <iosfwd>
 #include <stop_token>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
+/// Set to 0 to build without try/catch anywhere in retry() and RetryLoop, which is the
+/// default when the compiler has exceptions disabled (e.g. -fno-exceptions).
+#ifndef RETRYXX_EXCEPTIONS
+ #if defined (__cpp_exceptions) || defined (__EXCEPTIONS) || defined (_CPPUNWIND)
+  #define RETRYXX_EXCEPTIONS 1
+ #else
+  #define RETRYXX_EXCEPTIONS 0
+ #endif
+#endif
 
 #if __cpp_lib_expected >= 202202L
 #include <expected>
@@ -73,11 +96,118 @@ namespace retryxx
 {
     using stop_token  = std::stop_token;
     using stop_source = std::stop_source;
+
+    template <typename Callback>
+    using stop_callback = std::stop_callback<Callback>;
 }
 
 #else
 #include <atomic>
 
+namespace retryxx::detail
+{
+/// Type-erased registration in a StopState's callback list.
+class StopCallbackBase
+{
+public:
+    virtual void invoke() noexcept = 0;
+
+protected:
+    ~StopCallbackBase() = default;
+
+private:
+    friend class StopState;
+
+    StopCallbackBase* prev = nullptr;
+    StopCallbackBase* next = nullptr;
+};
+
+/// Shared cancellation state of the fallback stop_source and its tokens and callbacks.
+class StopState
+{
+public:
+    bool stopRequested() const noexcept { return stopped.load (std::memory_order_acquire); }
+
+    /// Sets the stop flag and runs every registered callback on the calling thread.
+    /// @returns    False if stop had already been requested
+    bool requestStop() noexcept
+    {
+        std::unique_lock lock (mutex);
+        if (stopped.exchange (true, std::memory_order_acq_rel))
+        {
+            return false;
+        }
+
+        invokingThread = std::this_thread::get_id();
+
+        while (auto* callback = callbacks)
+        {
+            unlink (callback);
+            running = callback;
+            lock.unlock();
+            callback->invoke();
+            lock.lock();
+            running = nullptr;
+            finished.notify_all();
+        }
+
+        return true;
+    }
+
+    /// Registers callback, or returns false without registering it if stop was already requested
+    bool add (StopCallbackBase* callback) noexcept
+    {
+        std::lock_guard lock (mutex);
+        if (stopRequested())
+        {
+            return false;
+        }
+
+        callback->next = callbacks;
+        (callbacks != nullptr ? callbacks->prev : callback->prev) = callback;
+        callback->prev = nullptr;
+        callbacks = callback;
+        return true;
+    }
+
+    /// Deregisters callback, waiting for it to return if another thread is running it
+    void remove (StopCallbackBase* callback) noexcept
+    {
+        std::unique_lock lock (mutex);
+        if (callback->prev != nullptr || callbacks == callback)
+        {
+            unlink (callback);
+            return;
+        }
+
+        if (running == callback && invokingThread != std::this_thread::get_id())
+        {
+            finished.wait (lock, [&] { return running != callback; });
+        }
+    }
+
+private:
+    void unlink (StopCallbackBase* callback) noexcept
+    {
+        (callback->prev != nullptr ? callback->prev->next : callbacks) = callback->next;
+        if (callback->next != nullptr)
+        {
+            callback->next->prev = callback->prev;
+        }
+
+        callback->prev = callback->next = nullptr;
+    }
+
+    std::atomic<bool> stopped { false };
+    std::mutex mutex;
+    std::condition_variable finished;
+    StopCallbackBase* callbacks = nullptr;
+    StopCallbackBase* running = nullptr;
+    std::thread::id invokingThread;
+};
+
+} // namespace detail
+
 namespace retryxx
 {
 /// Fallback implementation of std::stop_token for C++20 compatibility.
@@ -86,35 +216,83 @@ class stop_token
 {
 public:
     stop_token() = default;
-    explicit stop_token (const std::atomic<bool>* flag) : stopFlag (flag) {}
+    explicit stop_token (detail::StopState* stopState) : state (stopState) {}
 
     /// Returns true if cancellation has been requested
-    bool stop_requested() const noexcept { return stopFlag && stopFlag->load(); }
+    bool stop_requested() const noexcept { return state && state->stopRequested(); }
 
     /// Returns true if this token is associated with a stop source
-    bool stop_possible() const noexcept  { return stopFlag != nullptr; }
+    bool stop_possible() const noexcept  { return state != nullptr; }
 
 private:
-    const std::atomic<bool>* stopFlag = nullptr;
+    template <typename Callback>
+    friend class stop_callback;
+
+    detail::StopState* state = nullptr;
 };
 
 /// Fallback implementation of std::stop_source for C++20 compatibility.
 /// Manages the cancellation state and provides tokens for cooperative cancellation.
+/// Unlike std::stop_source the state is owned here, so the source must outlive its tokens.
 class stop_source
 {
 public:
     stop_source() = default;
 
-    /// Requests cancellation for all associated tokens
-    void request_stop() noexcept    { stopped.store (true); }
+    /// Requests cancellation for all associated tokens and runs their callbacks
+    bool request_stop() noexcept    { return state.requestStop(); }
 
     /// Returns a token that can be used to check for cancellation
-    stop_token get_token() noexcept { return stop_token (&stopped); }
+    stop_token get_token() noexcept { return stop_token (&state); }
 
 private:
-    std::atomic<bool> stopped { false };
+    detail::StopState state;
+};
+
+/// Fallback implementation of std::stop_callback for C++20 compatibility.
+/// Invokes the callback when stop is requested, or immediately if it already was.
+template <typename Callback>
+class stop_callback : private detail::StopCallbackBase
+{
+public:
+    template <typename C>
+    explicit stop_callback (const stop_token& token, C&& cb)
+      : callback (std::forward<C> (cb))
+    {
+        if (token.state != nullptr)
+        {
+            if (token.state->add (this))
+            {
+                state = token.state;
+            }
+            else
+            {
+                invoke();
+            }
+        }
+    }
+
+    ~stop_callback()
+    {
+        if (state != nullptr)
+        {
+            state->remove (this);
+        }
+    }
+
+    stop_callback (const stop_callback&) = delete;
+    stop_callback& operator= (const stop_callback&) = delete;
+
+private:
+    void invoke() noexcept override { callback(); }
+
+    Callback callback;
+    detail::StopState* state = nullptr;
 };
 
+template <typename Callback>
+stop_callback (stop_token, Callback) -> stop_callback<Callback>;
+
 } // namespace retryxx
 
 #endif
@@ -129,122 +307,1636 @@ bool interruptibleSleep (std::chrono::milliseconds duration, stop_token stopToke
 namespace retryxx
 {
 
+/// A callable that takes a stop_token ahead of its other arguments. Every attempt is passed
+/// the retry's token, so an attempt still running when the retry is cancelled can abandon
+/// its work instead of being waited for.
+template <typename F, typename... Args>
+concept StopTokenAware = std::is_invocable_v<F&, stop_token, Args...>;
+
+/// A callable that can be invoked once per attempt, optionally taking a stop_token first.
+/// Attempts always invoke it as an lvalue, so a callable whose call operator is
+/// &&-qualified is not Retryable.
+template <typename F, typename... Args>
+concept Retryable = std::is_invocable_v<F&, Args...> || StopTokenAware<F, Args...>;
+
+} // namespace retryxx
+
+namespace retryxx::detail
+{
+
+/// Invokes an attempt, passing it the stop token if it accepts one.
+template <typename F, typename... Args>
+decltype (auto) invokeAttempt (F& func, const stop_token& stopToken, Args&&... args)
+{
+    if constexpr (StopTokenAware<F, Args...>)
+    {
+        return std::invoke (func, stopToken, std::forward<Args> (args)...);
+    }
+    else
+    {
+        return std::invoke (func, std::forward<Args> (args)...);
+    }
+}
+
+/// Computed without instantiating invokeAttempt, so that a substitution with a type that
+/// is not Retryable fails softly and the overloads of retry() can tell policies from callables
+template <typename F, typename... Args>
+struct AttemptResultOf : std::invoke_result<F&, Args...> {};
+
 template <typename F, typename... Args>
-concept Retryable = std::is_invocable_v<F, Args...>;
+    requires StopTokenAware<F, Args...>
+struct AttemptResultOf<F, Args...> : std::invoke_result<F&, const stop_token&, Args...> {};
+
+/// The value produced by one attempt of F
+template <typename F, typename... Args>
+using AttemptResult = std::remove_cvref_t<typename AttemptResultOf<F, Args...>::type>;
+
+} // namespace detail
+
+namespace retryxx
+{
+
+/// Small, fast pseudo-random generator used for backoff jitter (SplitMix64).
+/// Eight bytes of state, which is plenty for spreading retry delays, where
+/// std::mt19937_64 carries about 2.5 KB.
+class SplitMix64
+{
+public:
+    using result_type = std::uint64_t;
+
+    explicit SplitMix64 (std::uint64_t seed = 0) noexcept : state (seed) {}
+
+    static constexpr result_type min() noexcept { return 0; }
+    static constexpr result_type max() noexcept { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() noexcept
+    {
+        auto z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+private:
+    std::uint64_t state;
+};
+
+/// A source of retry delays that retry() and its siblings can wait on between attempts.
+template <typename P>
+concept BackoffStrategy = std::copy_constructible<P> && requires (const P& policy, int attempt)
+{
+    { policy.getDelay (attempt) } -> std::convertible_to<std::chrono::milliseconds>;
+};
+
+/// A backoff strategy that wants to learn from every attempt. retry() and its siblings
+/// report whether each attempt was accepted and how long it took.
+template <typename P>
+concept AdaptiveBackoffStrategy = BackoffStrategy<P> && requires (P& policy, bool succeeded, std::chrono::nanoseconds latency)
+{
+    policy.recordOutcome (succeeded, latency);
+};
+
+} // namespace retryxx
+
+namespace retryxx::detail
+{
+
+/// Returns the calling thread's generator of type Rng, seeded from std::random_device
+/// the first time the thread asks for it.
+template <typename Rng>
+Rng& threadLocalRng()
+{
+    thread_local Rng rng { [] {
+        std::random_device device;
+        return (static_cast<std::uint64_t> (device()) << 32) ^ device();
+    }() };
+
+    return rng;
+}
+
+} // namespace detail
+
+namespace retryxx
+{
+
+/// Jitter strategy that waits exactly the exponential delay.
+struct NoJitter
+{
+    template <typename Rng>
+    long long operator() (int, long long exponentialDelay, long long, long long, Rng&) const noexcept
+    {
+        return exponentialDelay;
+    }
+};
+
+/// Jitter strategy that waits a uniformly random time between 0 and the exponential delay.
+/// Spreads clients the most, at the cost of occasionally retrying almost immediately.
+struct FullJitter
+{
+    template <typename Rng>
+    long long operator() (int, long long exponentialDelay, long long, long long, Rng& rng) const
+    {
+        std::uniform_int_distribution<long long> dist (0, exponentialDelay);
+        return dist (rng);
+    }
+};
+
+/// Jitter strategy that waits half the exponential delay plus a uniformly random time up to
+/// the other half, so a retry never comes sooner than half its exponential delay.
+struct EqualJitter
+{
+    template <typename Rng>
+    long long operator() (int, long long exponentialDelay, long long, long long, Rng& rng) const
+    {
+        auto half = exponentialDelay / 2;
+        std::uniform_int_distribution<long long> dist (0, exponentialDelay - half);
+        return half + dist (rng);
+    }
+};
+
+/// Jitter strategy that draws each delay between initialDelay and three times the previous
+/// delay, capped at maxDelay ("decorrelated jitter"). It ignores the multiplier and keeps
+/// the previous delay, so each retry operation needs its own copy of the policy, which
+/// retry() and its siblings already make.
+struct DecorrelatedJitter
+{
+    template <typename Rng>
+    long long operator() (int attempt, long long, long long initialDelay, long long maxDelay, Rng& rng)
+    {
+        if (attempt <= 1 || previousDelay < initialDelay)
+        {
+            previousDelay = initialDelay;
+        }
+
+        auto upper = previousDelay > maxDelay / 3 ? maxDelay : std::max (previousDelay * 3, initialDelay);
+        std::uniform_int_distribution<long long> dist (std::min (initialDelay, upper), upper);
+        previousDelay = dist (rng);
+        return previousDelay;
+    }
+
+    long long previousDelay = 0;
+};
 
 /// Configures the exponential backoff timing strategy for retry operations.
 /// Uses exponential growth with jitter to prevent synchronized retry attempts
 /// across multiple clients (thundering herd problem).
-struct BackoffPolicy
+/// The jitter is drawn from a thread-local generator of type Rng and shaped by the Jitter
+/// strategy, a compile-time choice so the selected one inlines into getDelay(). A policy
+/// is its three timing parameters plus any state the strategy keeps, and is trivially copyable.
+template <typename Rng = SplitMix64, typename Jitter = FullJitter>
+struct BasicBackoffPolicy
 {
+    using RandomEngine = Rng;
+    using JitterStrategy = Jitter;
+
     std::chrono::milliseconds initialDelay;
     double multiplier;
     std::chrono::milliseconds maxDelay;
-    mutable std::mt19937_64 rng;
 
     /// Creates a backoff policy with the specified timing parameters.
     /// @param initial    Starting delay for first retry (default: 1 second)
     /// @param mult       Multiplier for exponential growth (default: 2.0)
     /// @param max        Maximum delay cap (default: 5 minutes)
-    BackoffPolicy (std::chrono::milliseconds initial = std::chrono::seconds (1),
-                   double mult = 2.0,
-                   std::chrono::milliseconds max = std::chrono::minutes (5))
+    BasicBackoffPolicy (std::chrono::milliseconds initial = std::chrono::seconds (1),
+                        double mult = 2.0,
+                        std::chrono::milliseconds max = std::chrono::minutes (5))
       : initialDelay (initial),
         multiplier (mult),
         maxDelay (max)
     {
-        rng.seed (std::random_device{}());
     }
 
-    /// Calculates the randomized delay for the given retry attempt.
+    /// Calculates the exponential delay for the given retry attempt before jitter is applied.
+    /// This is initialDelay * multiplier^(attempt - 1) saturated at maxDelay, evaluated in
+    /// closed form so fractional multipliers are honoured and the cost does not grow with attempt.
     /// @param attempt   The retry attempt number (1-based)
-    /// @returns         Random delay between 0 and the calculated exponential delay
-    std::chrono::milliseconds getDelay (int attempt) const
+    /// @returns         The capped exponential delay
+    std::chrono::milliseconds getBaseDelay (int attempt) const
     {
-        std::chrono::milliseconds currentDelay = initialDelay;
-        for (int i = 0; i < attempt - 1; ++i)
+        auto cap = static_cast<double> (maxDelay.count());
+        auto delay = static_cast<double> (initialDelay.count()) * std::pow (multiplier, std::max (attempt - 1, 0));
+
+        if (! (delay < cap))
         {
-            currentDelay = std::min (currentDelay * static_cast<long long> (multiplier), maxDelay);
+            return std::max (maxDelay, std::chrono::milliseconds (0));
         }
 
-        std::uniform_int_distribution<long long> dist (0, currentDelay.count());
-        return std::chrono::milliseconds (dist (rng));
+        return std::chrono::milliseconds (delay > 0.0 ? static_cast<long long> (delay) : 0);
+    }
+
+    /// Calculates the randomized delay for the given retry attempt.
+    /// @param attempt   The retry attempt number (1-based)
+    /// @returns         The delay chosen by the Jitter strategy, never more than maxDelay
+    std::chrono::milliseconds getDelay (int attempt) const
+    {
+        return std::chrono::milliseconds (jitter (attempt,
+                                                  getBaseDelay (attempt).count(),
+                                                  std::max<long long> (initialDelay.count(), 0),
+                                                  std::max<long long> (maxDelay.count(), 0),
+                                                  detail::threadLocalRng<Rng>()));
     }
+
+private:
+    [[no_unique_address]] mutable Jitter jitter;
 };
 
-/// Executes a function with retry logic using exponential backoff and jitter.
-/// The function is retried based on both its return value and any exceptions thrown.
-/// @param func                             The function to execute and potentially retry
-/// @param shouldRetryPredicate             Determines if result should trigger a retry
-/// @param shouldRetryExceptionPredicate    Determines if exception should trigger a retry
-/// @param maxAttempts                      Maximum number of retry attempts
-/// @param backoffPolicy                    Timing configuration for retries
-/// @param stopToken                        Token for cooperative cancellation of retry operation
-/// @returns                                Expected containing either the successful result or error message
-template <Retryable F, typename ShouldRetryPredicate,
-                       typename ShouldRetryExceptionPredicate,
-                       typename ResultType = std::invoke_result_t<F>>
-expected<ResultType, std::string> retry (F&& func,
-                                         ShouldRetryPredicate&& shouldRetryPredicate,
-                                         ShouldRetryExceptionPredicate&& shouldRetryExceptionPredicate,
-                                         int maxAttempts = 5,
-                                         BackoffPolicy backoffPolicy = BackoffPolicy{},
-                                         stop_token stopToken = stop_token{})
+/// The default backoff policy, drawing full jitter from SplitMix64.
+using BackoffPolicy = BasicBackoffPolicy<>;
+
+/// A backoff policy using the given jitter strategy, e.g. JitteredBackoffPolicy<DecorrelatedJitter>.
+template <typename Jitter>
+using JitteredBackoffPolicy = BasicBackoffPolicy<SplitMix64, Jitter>;
+
+static_assert (std::is_trivially_copyable_v<BackoffPolicy>);
+static_assert (std::is_trivially_copyable_v<JitteredBackoffPolicy<DecorrelatedJitter>>);
+static_assert (sizeof (BackoffPolicy) == sizeof (JitteredBackoffPolicy<NoJitter>));
+
+/// Why a retry operation gave up.
+enum class RetryErrorReason
+{
+    exhausted,               ///< Every attempt was used up without an acceptable result
+    cancelled,               ///< Cancellation was requested through the stop token, or the retry's scheduler shut down
+    nonRetryableException,   ///< An attempt threw an exception the predicate chose not to retry
+    budgetExhausted,         ///< The shared RetryBudget refused another retry
+    circuitOpen,             ///< The CircuitBreaker is open, so the dependency was not called
+    deadlineExceeded,        ///< Another attempt could not have completed before the deadline
+    invalidArgument          ///< The retry was set up in a way it cannot carry out, so nothing was attempted
+};
+
+/// Error half of the expected returned by retry(). It is a few words of plain data,
+/// so failing costs no allocation; call message() to format it when it is needed.
+struct RetryError
 {
-    for (int attempts = 0; attempts < maxAttempts; ++attempts)
+    RetryErrorReason reason;
+
+    /// Number of attempts that were made before giving up
+    int attempts = 0;
+
+    /// The exception that ended the retry, or that the last attempt threw when exhausted
+    std::exception_ptr exception;
+
+    /// Formats a human-readable description of the error.
+    std::string message() const
     {
-        try
+        switch (reason)
         {
-            if (attempts > 0)
-            {
-                if (detail::interruptibleSleep (backoffPolicy.getDelay (attempts), stopToken))
-                {
-                    return unexpected ("Retry operation was cancelled during backoff.");
-                }
-            }
+            case RetryErrorReason::exhausted:
+                return "Retry failed after " + std::to_string (attempts) + " attempts.";
 
-            ResultType result = std::invoke (std::forward<F> (func));
-            if (! shouldRetryPredicate (result))
+            case RetryErrorReason::cancelled:
+                return "Retry operation was cancelled after " + std::to_string (attempts) + " attempts.";
+
+            case RetryErrorReason::nonRetryableException:
+                return "Retry failed with exception: " + exceptionMessage();
+
+            case RetryErrorReason::budgetExhausted:
+                return "Retry budget exhausted after " + std::to_string (attempts) + " attempts.";
+
+            case RetryErrorReason::circuitOpen:
+                return "Circuit breaker open after " + std::to_string (attempts) + " attempts.";
+
+            case RetryErrorReason::deadlineExceeded:
+                return "Retry deadline exceeded after " + std::to_string (attempts) + " attempts.";
+
+            case RetryErrorReason::invalidArgument:
+                return "Retry could not start with the arguments given.";
+        }
+
+        return {};
+    }
+
+private:
+    std::string exceptionMessage() const
+    {
+#if RETRYXX_EXCEPTIONS
+        try
+        {
+            if (exception)
             {
-                return result;
+                std::rethrow_exception (exception);
             }
         }
         catch (const std::exception& e)
         {
-            if (! shouldRetryExceptionPredicate (e))
-            {
-                return unexpected (std::format ("Retry failed with exception: {}", e.what()));
-            }
+            return e.what();
+        }
+        catch (...)
+        {
         }
+#endif
+
+        return "unknown exception";
     }
+};
 
-    return unexpected (std::format ("Retry failed after {} attempts.", maxAttempts));
+template <typename CharT, typename Traits>
+std::basic_ostream<CharT, Traits>& operator<< (std::basic_ostream<CharT, Traits>& stream, const RetryError& error)
+{
+    return stream << error.message().c_str();
 }
 
-} // namespace retryxx
+/// What a predicate wants done with an attempt, for predicates that need more than a bool,
+/// e.g. to honour a server's Retry-After or pushback hint. A bool converts implicitly, so
+/// true means retry() and false means stop().
+class RetryDecision
+{
+public:
+    enum class Kind : std::uint8_t
+    {
+        stop,         ///< Accept the result, or give up on the exception
+        retry,        ///< Retry after the backoff policy's delay
+        retryAfter    ///< Retry after an explicit delay instead of the policy's
+    };
 
-namespace retryxx::detail
+    constexpr RetryDecision (bool shouldRetry) noexcept : kind (shouldRetry ? Kind::retry : Kind::stop) {}
+
+    static constexpr RetryDecision stop() noexcept                                  { return RetryDecision (false); }
+    static constexpr RetryDecision retry() noexcept                                 { return RetryDecision (true); }
+
+    /// Retries after delay, which replaces the policy's delay but still counts as an attempt
+    /// and is still shortened or refused to meet a deadline.
+    static constexpr RetryDecision retryAfter (std::chrono::milliseconds delay) noexcept
+    {
+        RetryDecision decision (true);
+        decision.kind = Kind::retryAfter;
+        decision.delay = std::max (delay, std::chrono::milliseconds (0));
+        return decision;
+    }
+
+    constexpr Kind getKind() const noexcept                                         { return kind; }
+    constexpr bool shouldRetry() const noexcept                                     { return kind != Kind::stop; }
+
+    /// Returns the explicit delay, only meaningful for Kind::retryAfter
+    constexpr std::chrono::milliseconds getDelay() const noexcept                  { return delay; }
+
+private:
+    Kind kind;
+    std::chrono::milliseconds delay { 0 };
+};
+
+/// A source of time for retry operations that also waits out their backoffs. now() is
+/// used for deadlines and attempt durations; sleepFor() returns true if the wait was cut
+/// short because stop was requested.
+template <typename C>
+concept RetryClock = requires (const C& clock, std::chrono::milliseconds duration, const stop_token& stopToken)
 {
+    { clock.now() } -> std::convertible_to<std::chrono::steady_clock::time_point>;
+    { clock.sleepFor (duration, stopToken) } -> std::convertible_to<bool>;
+};
 
-inline bool interruptibleSleep (std::chrono::milliseconds duration, stop_token stopToken)
+/// The default RetryClock: std::chrono::steady_clock, with each backoff blocking the
+/// retrying thread until it elapses or stop is requested.
+struct SteadyClock
 {
-    if (! stopToken.stop_possible())
+    static std::chrono::steady_clock::time_point now() noexcept
     {
-        std::this_thread::sleep_for (duration);
-        return false;
+        return std::chrono::steady_clock::now();
+    }
+
+    static bool sleepFor (std::chrono::milliseconds duration, const stop_token& stopToken)
+    {
+        return detail::interruptibleSleep (duration, stopToken);
+    }
+};
+
+/// Token bucket that caps retries to a fraction of requests, shared by every retry()
+/// call against the same dependency. Each call deposits retryRatio tokens and each retry
+/// withdraws one, so when a dependency degrades the extra load from retries stays bounded
+/// instead of multiplying by maxAttempts.
+///
+/// The balance is split across cache-line sized shards picked per thread. All updates are
+/// relaxed atomics, and once the bucket is full a deposit is a single load. The layout is
+/// fixed and holds no pointers, so a budget can also be shared between processes through
+/// SharedMemoryObject.
+class RetryBudget
+{
+public:
+    /// Creates a budget that starts full.
+    /// @param retryRatio       Retries allowed per request (default: 0.1, i.e. 10%)
+    /// @param maxRetryBurst    Maximum number of retries that can be saved up, at least one per shard (default: 100)
+    explicit RetryBudget (double retryRatio = 0.1, int maxRetryBurst = 100) noexcept
+      : depositPerRequest (static_cast<std::int64_t> (std::max (retryRatio, 0.0) * tokenScale)),
+        shardCapacity (std::max<std::int64_t> (std::int64_t (maxRetryBurst) * tokenScale / numShards, tokenScale))
+    {
+        for (auto& shard : shards)
+        {
+            shard.balance.store (shardCapacity, std::memory_order_relaxed);
+        }
     }
 
-    auto sleepIncrement = std::chrono::milliseconds (10);
-    auto remaining = duration;
+    RetryBudget (const RetryBudget&) = delete;
+    RetryBudget& operator= (const RetryBudget&) = delete;
 
-    while (remaining > std::chrono::milliseconds (0) && ! stopToken.stop_requested())
+    /// Deposits one request's share of retry tokens.
+    void recordRequest() noexcept
     {
-        auto sleepTime = std::min (sleepIncrement, remaining);
-        std::this_thread::sleep_for (sleepTime);
-        remaining -= sleepTime;
+        auto& balance = shards[shardIndex()].balance;
+        auto current = balance.load (std::memory_order_relaxed);
+
+        while (current < shardCapacity
+               && ! balance.compare_exchange_weak (current,
+                                                   std::min (current + depositPerRequest, shardCapacity),
+                                                   std::memory_order_relaxed))
+        {
+        }
     }
 
-    return stopToken.stop_requested();
+    /// Withdraws the token for one retry, from the calling thread's shard if it can
+    /// and from the others if that one is empty.
+    /// @returns    False if the budget has no retry left
+    bool tryConsumeRetry() noexcept
+    {
+        auto first = shardIndex();
+
+        for (std::size_t i = 0; i < numShards; ++i)
+        {
+            auto& balance = shards[(first + i) % numShards].balance;
+            auto current = balance.load (std::memory_order_relaxed);
+
+            while (current >= tokenScale)
+            {
+                if (balance.compare_exchange_weak (current, current - tokenScale, std::memory_order_relaxed))
+                {
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    /// Returns an approximate count of the retries currently available
+    double availableRetries() const noexcept
+    {
+        std::int64_t total = 0;
+        for (const auto& shard : shards)
+        {
+            total += shard.balance.load (std::memory_order_relaxed);
+        }
+
+        return static_cast<double> (total) / tokenScale;
+    }
+
+private:
+    static constexpr std::size_t numShards = 16;
+    static constexpr std::int64_t tokenScale = 1000;
+
+    struct alignas (64) Shard
+    {
+        std::atomic<std::int64_t> balance { 0 };
+    };
+
+    // Each process starts at a random shard, so that the first threads of processes sharing
+    // a budget do not all land on the same one
+    static std::size_t shardIndex() noexcept
+    {
+        static std::atomic<std::size_t> nextThread { std::random_device{}() };
+        thread_local const auto index = nextThread.fetch_add (1, std::memory_order_relaxed) % numShards;
+        return index;
+    }
+
+    const std::int64_t depositPerRequest;
+    const std::int64_t shardCapacity;
+    std::array<Shard, numShards> shards;
+};
+
+/// Circuit breaker shared by every retry() call against the same dependency.
+/// While closed, calls go through and their outcomes are counted in a sliding window.
+/// Once the failure rate in the window crosses the threshold the breaker opens and calls
+/// fail immediately instead of sleeping through the backoff schedule. After openDuration
+/// it lets a single probe through (half-open) and closes again if that probe succeeds.
+///
+/// State and counters are plain atomics with no locks and no pointers, so a breaker can
+/// also be shared between processes through SharedMemoryObject as long as its clock reads
+/// the same time in all of them, as steady_clock does.
+class CircuitBreaker
+{
+public:
+    enum class State
+    {
+        closed,
+        open,
+        halfOpen
+    };
+
+    /// Creates a closed circuit breaker.
+    /// @param failureThreshold    Failure rate in the window that opens the breaker (default: 0.5)
+    /// @param minimumRequests     Calls needed in the window before it can open (default: 20)
+    /// @param window              Length of the sliding window (default: 10 seconds)
+    /// @param openDuration        How long to stay open before probing (default: 30 seconds)
+    explicit CircuitBreaker (double failureThreshold = 0.5,
+                             int minimumRequests = 20,
+                             std::chrono::milliseconds window = std::chrono::seconds (10),
+                             std::chrono::milliseconds openDuration = std::chrono::seconds (30)) noexcept
+      : failureThreshold (failureThreshold),
+        minimumRequests (std::max (minimumRequests, 1)),
+        bucketNanos (std::max<std::int64_t> (std::chrono::nanoseconds (window).count() / numBuckets, 1)),
+        openNanos (std::chrono::nanoseconds (openDuration).count())
+    {
+    }
+
+    CircuitBreaker (const CircuitBreaker&) = delete;
+    CircuitBreaker& operator= (const CircuitBreaker&) = delete;
+
+    /// Returns true if a call may go ahead. When the open period has elapsed the first
+    /// caller is let through as the half-open probe; everyone else is refused until it reports.
+    /// The open period is timed by clock, which must be the same for every call.
+    template <RetryClock Clock = SteadyClock>
+    bool allowRequest (const Clock& clock = Clock{}) noexcept
+    {
+        auto word = stateWord.load (std::memory_order_acquire);
+
+        if (stateOf (word) == State::closed)
+        {
+            return true;
+        }
+
+        auto now = nanosOf (clock.now());
+
+        if (stateOf (word) == State::open)
+        {
+            if (now - timeOf (word) < openNanos
+                || ! stateWord.compare_exchange_strong (word, pack (State::halfOpen, now), std::memory_order_acq_rel))
+            {
+                return false;
+            }
+
+            return true;
+        }
+
+        // A probe that never reported back is replaced once another open period has passed
+        return now - timeOf (word) >= openNanos
+            && stateWord.compare_exchange_strong (word, pack (State::halfOpen, now), std::memory_order_acq_rel);
+    }
+
+    /// Records a call whose result was accepted
+    template <RetryClock Clock = SteadyClock>
+    void recordSuccess (const Clock& clock = Clock{}) noexcept
+    {
+        auto word = stateWord.load (std::memory_order_acquire);
+
+        if (stateOf (word) == State::halfOpen)
+        {
+            resetWindow();
+            stateWord.compare_exchange_strong (word, pack (State::closed, 0), std::memory_order_acq_rel);
+            return;
+        }
+
+        record (false, nanosOf (clock.now()));
+    }
+
+    /// Records a call that failed or whose result was rejected
+    template <RetryClock Clock = SteadyClock>
+    void recordFailure (const Clock& clock = Clock{}) noexcept
+    {
+        auto word = stateWord.load (std::memory_order_acquire);
+        auto now = nanosOf (clock.now());
+
+        if (stateOf (word) == State::halfOpen)
+        {
+            stateWord.compare_exchange_strong (word, pack (State::open, now), std::memory_order_acq_rel);
+            return;
+        }
+
+        record (true, now);
+
+        if (stateOf (word) == State::closed && shouldTrip (now))
+        {
+            stateWord.compare_exchange_strong (word, pack (State::open, now), std::memory_order_acq_rel);
+        }
+    }
+
+    /// Returns the current state, reporting open even once the open period has elapsed
+    /// until a caller has been let through as the probe
+    State getState() const noexcept    { return stateOf (stateWord.load (std::memory_order_acquire)); }
+
+private:
+    static constexpr int numBuckets = 10;
+
+    struct alignas (64) Bucket
+    {
+        std::atomic<std::int64_t> epoch { -1 };
+        std::atomic<std::uint32_t> successes { 0 };
+        std::atomic<std::uint32_t> failures { 0 };
+    };
+
+    // The state lives in the low two bits and the time it was entered in the rest, so
+    // both change together in one atomic operation
+    static std::uint64_t pack (State state, std::int64_t nanos) noexcept
+    {
+        return (static_cast<std::uint64_t> (nanos) << 2) | static_cast<std::uint64_t> (state);
+    }
+
+    static State stateOf (std::uint64_t word) noexcept           { return static_cast<State> (word & 3); }
+    static std::int64_t timeOf (std::uint64_t word) noexcept     { return static_cast<std::int64_t> (word >> 2); }
+
+    static std::int64_t nanosOf (std::chrono::steady_clock::time_point time) noexcept
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds> (time.time_since_epoch()).count();
+    }
+
+    void record (bool failed, std::int64_t now) noexcept
+    {
+        auto epoch = now / bucketNanos;
+        auto& bucket = buckets[static_cast<std::size_t> (epoch % numBuckets)];
+        auto bucketEpoch = bucket.epoch.load (std::memory_order_acquire);
+
+        if (bucketEpoch != epoch && bucket.epoch.compare_exchange_strong (bucketEpoch, epoch, std::memory_order_acq_rel))
+        {
+            bucket.successes.store (0, std::memory_order_relaxed);
+            bucket.failures.store (0, std::memory_order_relaxed);
+        }
+
+        (failed ? bucket.failures : bucket.successes).fetch_add (1, std::memory_order_relaxed);
+    }
+
+    bool shouldTrip (std::int64_t now) const noexcept
+    {
+        auto epoch = now / bucketNanos;
+        std::uint64_t successes = 0, failures = 0;
+
+        for (const auto& bucket : buckets)
+        {
+            auto bucketEpoch = bucket.epoch.load (std::memory_order_acquire);
+
+            // A reset bucket is marked -1, which would otherwise look recent to a clock near its epoch
+            if (bucketEpoch >= 0 && epoch - bucketEpoch < numBuckets)
+            {
+                successes += bucket.successes.load (std::memory_order_relaxed);
+                failures += bucket.failures.load (std::memory_order_relaxed);
+            }
+        }
+
+        auto total = successes + failures;
+        return total >= static_cast<std::uint64_t> (minimumRequests)
+            && static_cast<double> (failures) >= failureThreshold * static_cast<double> (total);
+    }
+
+    void resetWindow() noexcept
+    {
+        for (auto& bucket : buckets)
+        {
+            bucket.epoch.store (-1, std::memory_order_release);
+        }
+    }
+
+    const double failureThreshold;
+    const int minimumRequests;
+    const std::int64_t bucketNanos;
+    const std::int64_t openNanos;
+    std::atomic<std::uint64_t> stateWord { 0 };
+    std::array<Bucket, numBuckets> buckets;
+};
+
+/// The default observer: it has no callbacks, so every notification compiles away.
+struct NoObserver
+{
+};
+
+} // namespace retryxx
+
+namespace retryxx::detail
+{
+
+/// Observers are held either by value or through a pointer to one shared between calls
+template <typename Observer>
+decltype (auto) observed (Observer& observer) noexcept
+{
+    if constexpr (std::is_pointer_v<Observer>)
+    {
+        return *observer;
+    }
+    else
+    {
+        return observer;
+    }
+}
+
+template <typename Observer>
+void notifyAttempt (Observer& observer, int attempt)
+{
+    decltype (auto) target = observed (observer);
+
+    if constexpr (requires { target.onAttempt (attempt); })
+    {
+        target.onAttempt (attempt);
+    }
+}
+
+template <typename Observer>
+void notifyBackoff (Observer& observer, int attempt, std::chrono::milliseconds delay)
+{
+    decltype (auto) target = observed (observer);
+
+    if constexpr (requires { target.onBackoff (attempt, delay); })
+    {
+        target.onBackoff (attempt, delay);
+    }
+}
+
+template <typename Observer>
+void notifySuccess (Observer& observer, int attempts)
+{
+    decltype (auto) target = observed (observer);
+
+    if constexpr (requires { target.onSuccess (attempts); })
+    {
+        target.onSuccess (attempts);
+    }
+}
+
+template <typename Observer>
+void notifyGiveUp (Observer& observer, const RetryError& error)
+{
+    decltype (auto) target = observed (observer);
+
+    if constexpr (requires { target.onGiveUp (error); })
+    {
+        target.onGiveUp (error);
+    }
+}
+
+/// Notifies the observer that the retry gave up and returns the error to hand back
+template <typename Observer>
+unexpected<RetryError> giveUp (Observer& observer, RetryError error)
+{
+    notifyGiveUp (observer, error);
+    return unexpected<RetryError> (std::move (error));
+}
+
+} // namespace detail
+
+namespace retryxx
+{
+
+/// Optional collaborators for a retry operation, typically shared by every call
+/// against the same dependency. Pass with designated initializers, e.g.
+/// { .budget = &budget }.
+///
+/// Observer is told about each step of the retry. It may be an object or a pointer to
+/// one, and may implement any of these, which are called on the retrying thread:
+///
+///     void onAttempt (int attempt);                                       // before each attempt
+///     void onBackoff (int attempt, std::chrono::milliseconds delay);      // before waiting to retry
+///     void onSuccess (int attempts);                                      // once a result is accepted
+///     void onGiveUp (const RetryError& error);                            // once the retry fails
+///
+/// An observer held by value is copied for each retry, and that copy receives every
+/// notification of the retry, so it may keep per-retry state in non-const members. To
+/// gather results across retries, hold a pointer to an observer they share instead.
+/// The default NoObserver implements none of them, so it costs nothing.
+template <typename Observer = NoObserver, RetryClock Clock = SteadyClock>
+struct BasicRetryOptions
+{
+    /// Consulted before every retry; when it refuses, the retry gives up with budgetExhausted
+    RetryBudget* budget = nullptr;
+
+    /// Consulted before every attempt and told each attempt's outcome; while it is open the
+    /// retry gives up with circuitOpen instead of calling the dependency or backing off
+    CircuitBreaker* circuitBreaker = nullptr;
+
+    /// Absolute time by which the retry must be over. Backoffs are shortened to fit the time
+    /// left, and the retry gives up with deadlineExceeded rather than start an attempt it
+    /// expects to overrun it, judged by the longest attempt it has made so far
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+
+    /// Longest an attempt may run before the stop token it was given is fired, zero for no limit.
+    /// Only callables that take a stop_token can be timed out, and the timeouts are measured in
+    /// real time by one watchdog thread shared by the whole process. A timed-out attempt is
+    /// judged by whatever it returns or throws once it stops, like any other attempt
+    std::chrono::milliseconds attemptTimeout { 0 };
+
+    /// Told about every attempt, backoff and outcome, see above
+    [[no_unique_address]] Observer observer {};
+
+    /// Where the retry reads the time and how it waits out backoffs, e.g. a VirtualClock
+    /// to run retry schedules without real sleeps. Used by the blocking entry points.
+    [[no_unique_address]] Clock clock {};
+
+    /// Returns true if a deadline has been set
+    bool hasDeadline() const noexcept    { return deadline != std::chrono::steady_clock::time_point::max(); }
+};
+
+/// Options without an observer, the type every entry point takes by default.
+using RetryOptions = BasicRetryOptions<>;
+
+} // namespace retryxx
+
+namespace retryxx::detail
+{
+
+/// Exception predicate of retry_expected(). Its exception type is never thrown, so the
+/// catch clauses for it never match and whatever an attempt throws propagates.
+struct PropagateExceptions
+{
+    struct Unthrowable
+    {
+    };
+
+    bool operator() (const Unthrowable&) const noexcept    { return false; }
+};
+
+/// The exception type a retry catches, given its exception predicate
+template <typename P>
+struct HandledExceptionType
+{
+    using type = std::exception;
+};
+
+template <>
+struct HandledExceptionType<PropagateExceptions>
+{
+    using type = PropagateExceptions::Unthrowable;
+};
+
+template <typename P>
+using HandledException = typename HandledExceptionType<std::remove_cvref_t<P>>::type;
+
+/// Results that carry an error value, such as retryxx::expected
+template <typename R>
+concept ExpectedLike = requires (const R& result)
+{
+    { result.has_value() } -> std::convertible_to<bool>;
+    result.error();
+};
+
+/// Process-wide thread that fires the stop tokens of attempts which overrun their timeout.
+/// Timers live in the attempts' own frames and sit in a min-heap ordered by deadline, so
+/// thousands of concurrent attempts share the one thread and arming a timer allocates nothing
+/// once the heap has grown. The stop source each timed attempt needs is another matter, see
+/// AttemptTimeout.
+class Watchdog
+{
+public:
+    struct Timer
+    {
+        std::chrono::steady_clock::time_point deadline;
+        stop_source* source = nullptr;
+        std::size_t heapIndex = notQueued;
+        bool firing = false;
+    };
+
+    /// Returns the shared watchdog, starting its thread on first use
+    static Watchdog& instance()
+    {
+        static Watchdog watchdog;
+        return watchdog;
+    }
+
+    /// Queues timer, which must stay alive until disarm() has returned
+    void arm (Timer& timer)
+    {
+        {
+            std::lock_guard lock (mutex);
+            timer.heapIndex = heap.size();
+            heap.push_back (&timer);
+            siftUp (timer.heapIndex);
+
+            // The thread only needs waking if it would otherwise sleep past this deadline
+            if (timer.deadline >= waitingUntil)
+            {
+                return;
+            }
+        }
+
+        wakeup.notify_one();
+    }
+
+    /// Removes timer, waiting for its stop callbacks to return if it is being fired
+    void disarm (Timer& timer)
+    {
+        std::unique_lock lock (mutex);
+
+        if (timer.heapIndex != notQueued)
+        {
+            removeAt (timer.heapIndex);
+            return;
+        }
+
+        fired.wait (lock, [&] { return ! timer.firing; });
+    }
+
+    Watchdog (const Watchdog&) = delete;
+    Watchdog& operator= (const Watchdog&) = delete;
+
+private:
+    static constexpr std::size_t notQueued = std::numeric_limits<std::size_t>::max();
+
+    Watchdog() : thread ([this] { run(); }) {}
+
+    ~Watchdog()
+    {
+        {
+            std::lock_guard lock (mutex);
+            stopping = true;
+        }
+
+        wakeup.notify_one();
+        thread.join();
+    }
+
+    void run()
+    {
+        std::unique_lock lock (mutex);
+
+        while (! stopping)
+        {
+            if (heap.empty())
+            {
+                waitingUntil = std::chrono::steady_clock::time_point::max();
+                wakeup.wait (lock);
+                continue;
+            }
+
+            auto* timer = heap.front();
+
+            if (timer->deadline > std::chrono::steady_clock::now())
+            {
+                waitingUntil = timer->deadline;
+                wakeup.wait_until (lock, waitingUntil);
+                continue;
+            }
+
+            // The stop callbacks run unlocked, so they may arm and disarm timers themselves
+            removeAt (0);
+            timer->firing = true;
+            lock.unlock();
+            timer->source->request_stop();
+            lock.lock();
+            timer->firing = false;
+            fired.notify_all();
+        }
+    }
+
+    void removeAt (std::size_t index)
+    {
+        heap[index]->heapIndex = notQueued;
+        auto* last = heap.back();
+        heap.pop_back();
+
+        if (index < heap.size())
+        {
+            heap[index] = last;
+            last->heapIndex = index;
+            siftUp (index);
+            siftDown (last->heapIndex);
+        }
+    }
+
+    void siftUp (std::size_t index)
+    {
+        while (index > 0)
+        {
+            auto parent = (index - 1) / 2;
+
+            if (! (heap[index]->deadline < heap[parent]->deadline))
+            {
+                break;
+            }
+
+            swapAt (index, parent);
+            index = parent;
+        }
+    }
+
+    void siftDown (std::size_t index)
+    {
+        for (;;)
+        {
+            auto smallest = index;
+
+            for (auto child : { 2 * index + 1, 2 * index + 2 })
+            {
+                if (child < heap.size() && heap[child]->deadline < heap[smallest]->deadline)
+                {
+                    smallest = child;
+                }
+            }
+
+            if (smallest == index)
+            {
+                return;
+            }
+
+            swapAt (index, smallest);
+            index = smallest;
+        }
+    }
+
+    void swapAt (std::size_t a, std::size_t b)
+    {
+        std::swap (heap[a], heap[b]);
+        heap[a]->heapIndex = a;
+        heap[b]->heapIndex = b;
+    }
+
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::condition_variable fired;
+    std::vector<Timer*> heap;
+    std::chrono::steady_clock::time_point waitingUntil = std::chrono::steady_clock::time_point::max();
+    bool stopping = false;
+    std::thread thread;
+};
+
+/// Stop token of one attempt with a timeout. It fires when the watchdog finds the attempt
+/// has overrun, or as soon as the caller's token does. A fired source cannot be reset, so
+/// every timed attempt gets a new one, and a std::stop_source allocates its shared state.
+class AttemptTimeout
+{
+public:
+    AttemptTimeout (const stop_token& callerToken, std::chrono::milliseconds timeout)
+      : forward (callerToken, Forward { &source })
+    {
+        timer.deadline = std::chrono::steady_clock::now() + timeout;
+        timer.source = &source;
+        Watchdog::instance().arm (timer);
+    }
+
+    ~AttemptTimeout()
+    {
+        Watchdog::instance().disarm (timer);
+    }
+
+    AttemptTimeout (const AttemptTimeout&) = delete;
+    AttemptTimeout& operator= (const AttemptTimeout&) = delete;
+
+    stop_token getToken() noexcept    { return source.get_token(); }
+
+private:
+    struct Forward
+    {
+        void operator()() const noexcept    { source->request_stop(); }
+
+        stop_source* source;
+    };
+
+    stop_source source;
+    stop_callback<Forward> forward;
+    Watchdog::Timer timer;
+};
+
+/// Invokes an attempt like invokeAttempt(), with its token also fired once timeout has
+/// elapsed if the attempt takes one and timeout is not zero.
+template <typename F, typename... Args>
+decltype (auto) invokeTimedAttempt (F& func, const stop_token& stopToken, std::chrono::milliseconds timeout, Args&&... args)
+{
+    if constexpr (StopTokenAware<F, Args...>)
+    {
+        if (timeout > timeout.zero())
+        {
+            AttemptTimeout attemptTimeout (stopToken, timeout);
+            return std::invoke (func, attemptTimeout.getToken(), std::forward<Args> (args)...);
+        }
+    }
+
+    return invokeAttempt (func, stopToken, std::forward<Args> (args)...);
+}
+
+/// Drives the attempt/backoff state machine shared by every retry entry point.
+/// Callers run attempts and wait out the backoff between them however suits them
+/// (blocking sleep, timer wheel, coroutine) while the retry semantics live here.
+template <typename ResultType, typename ShouldRetryPredicate, typename ShouldRetryExceptionPredicate, typename Policy,
+          typename Observer = NoObserver, typename Clock = SteadyClock>
+class RetryLoop
+{
+public:
+    using Result = expected<ResultType, RetryError>;
+    using Options = BasicRetryOptions<Observer, Clock>;
+
+    RetryLoop (ShouldRetryPredicate shouldRetry,
+               ShouldRetryExceptionPredicate shouldRetryException,
+               int maxAttempts,
+               Policy backoffPolicy,
+               Options retryOptions = Options{})
+      : shouldRetryPredicate (std::forward<ShouldRetryPredicate> (shouldRetry)),
+        shouldRetryExceptionPredicate (std::forward<ShouldRetryExceptionPredicate> (shouldRetryException)),
+        maxAttempts (maxAttempts),
+        backoffPolicy (std::move (backoffPolicy)),
+        options (std::move (retryOptions))
+    {
+    }
+
+    /// Invokes func once, as an lvalue, and feeds its outcome into the loop.
+    /// @param func         The attempt, passed stopToken if it is StopTokenAware
+    /// @param stopToken    Token through which the attempt learns the retry was cancelled
+    /// @returns            True once the loop has finished and takeResult() holds the outcome
+    template <typename F>
+    bool runAttempt (F& func, const stop_token& stopToken = stop_token{})
+    {
+        if (! beginAttempt())
+        {
+            return true;
+        }
+
+#if RETRYXX_EXCEPTIONS
+        try
+#endif
+        {
+            return onResult (invokeTimedAttempt (func, stopToken, options.attemptTimeout));
+        }
+#if RETRYXX_EXCEPTIONS
+        catch (const HandledException<ShouldRetryExceptionPredicate>& e)
+        {
+            return onException (e);
+        }
+#endif
+    }
+
+    /// Picks the loop up after attempts that the caller has already made itself.
+    /// @param attemptsMade     Number of attempts already made, all of which asked to be retried
+    /// @param exception        Exception thrown by the last of them, if any
+    /// @param lastStarted      When the last of them started, used to judge attempts against a deadline
+    /// @param decision         What the predicate decided about the last of them
+    /// @returns                True once the loop has finished
+    bool resume (int attemptsMade,
+                 std::exception_ptr exception,
+                 std::chrono::steady_clock::time_point lastStarted = {},
+                 RetryDecision decision = RetryDecision::retry())
+    {
+        attempts = attemptsMade;
+        lastException = std::move (exception);
+        lastDecision = decision;
+
+        if (options.hasDeadline() && attempts > 0)
+        {
+            longestAttempt = options.clock.now() - lastStarted;
+        }
+
+        return attempts >= maxAttempts ? exhausted() : retryRefused();
+    }
+
+    /// Claims the next attempt for callers that invoke the function themselves.
+    /// @returns    False if no attempts remain, in which case the loop has finished
+    bool beginAttempt()
+    {
+        if (attempts >= maxAttempts)
+        {
+            exhausted();
+            return false;
+        }
+
+        if (attempts == 0 && options.budget != nullptr)
+        {
+            options.budget->recordRequest();
+        }
+
+        if (options.hasDeadline())
+        {
+            attemptStarted = options.clock.now();
+
+            if (attemptStarted >= options.deadline)
+            {
+                fail (RetryErrorReason::deadlineExceeded);
+                return false;
+            }
+        }
+        else if constexpr (AdaptiveBackoffStrategy<Policy>)
+        {
+            attemptStarted = options.clock.now();
+        }
+
+        if (options.circuitBreaker != nullptr && ! options.circuitBreaker->allowRequest (options.clock))
+        {
+            fail (RetryErrorReason::circuitOpen);
+            return false;
+        }
+
+        ++attempts;
+        notifyAttempt (options.observer, attempts);
+        return true;
+    }
+
+    /// Records the value produced by the current attempt.
+    /// @returns    True once the loop has finished
+    bool onResult (ResultType&& result)
+    {
+        lastException = nullptr;
+        lastDecision = shouldRetryPredicate (result);
+
+        if (! lastDecision.shouldRetry())
+        {
+            recordOutcome (true);
+            notifySuccess (options.observer, attempts);
+            outcome.emplace (std::move (result));
+            return true;
+        }
+
+        recordOutcome (false);
+        return attempts >= maxAttempts ? exhausted() : retryRefused();
+    }
+
+    /// Records an exception thrown by the current attempt, must be called from its handler.
+    /// @returns    True once the loop has finished
+    template <typename Exception>
+    bool onException (const Exception& e)
+    {
+        lastException = std::current_exception();
+        lastDecision = shouldRetryExceptionPredicate (e);
+        recordOutcome (false);
+
+        if (! lastDecision.shouldRetry())
+        {
+            return fail (RetryErrorReason::nonRetryableException);
+        }
+
+        return attempts >= maxAttempts ? exhausted() : retryRefused();
+    }
+
+    /// Finishes the loop because cancellation was requested during backoff.
+    void cancel()
+    {
+        fail (RetryErrorReason::cancelled);
+    }
+
+    /// Returns the backoff to wait before the next attempt, which is the predicate's explicit
+    /// delay if it gave one. With a deadline it is shortened to leave the next attempt time
+    /// to complete, and that attempt becomes the last.
+    std::chrono::milliseconds nextDelay()
+    {
+        auto delay = lastDecision.getKind() == RetryDecision::Kind::retryAfter
+                         ? lastDecision.getDelay()
+                         : std::chrono::milliseconds (backoffPolicy.getDelay (attempts));
+
+        if (options.hasDeadline())
+        {
+            auto spare = std::chrono::duration_cast<std::chrono::milliseconds> (options.deadline - options.clock.now() - longestAttempt);
+
+            if (spare < delay)
+            {
+                delay = std::max (spare, std::chrono::milliseconds (0));
+                finalAttempt = true;
+            }
+        }
+
+        notifyBackoff (options.observer, attempts, delay);
+        return delay;
+    }
+
+    /// Returns the final outcome, only valid once the loop has finished.
+    Result takeResult()                          { return std::move (*outcome); }
+
+private:
+    /// Tells the breaker and an adaptive policy how the current attempt went
+    void recordOutcome (bool succeeded)
+    {
+        if (options.circuitBreaker != nullptr)
+        {
+            succeeded ? options.circuitBreaker->recordSuccess (options.clock) : options.circuitBreaker->recordFailure (options.clock);
+        }
+
+        if (AdaptiveBackoffStrategy<Policy> || options.hasDeadline())
+        {
+            auto elapsed = options.clock.now() - attemptStarted;
+            longestAttempt = std::max (longestAttempt, elapsed);
+
+            if constexpr (AdaptiveBackoffStrategy<Policy>)
+            {
+                backoffPolicy.recordOutcome (succeeded, elapsed);
+            }
+        }
+    }
+
+    bool exhausted()
+    {
+        return fail (RetryErrorReason::exhausted);
+    }
+
+    /// Asks the deadline, breaker and budget for the next retry, finishing the loop if any refuses
+    bool retryRefused()
+    {
+        if (options.hasDeadline())
+        {
+            auto remaining = options.deadline - options.clock.now() - longestAttempt;
+            auto hinted = lastDecision.getKind() == RetryDecision::Kind::retryAfter;
+
+            // An explicit delay is the server asking not to be called sooner, so a retry
+            // that cannot wait it out is not attempted at all
+            if (finalAttempt || remaining <= remaining.zero() || (hinted && lastDecision.getDelay() > remaining))
+            {
+                return fail (RetryErrorReason::deadlineExceeded);
+            }
+        }
+
+        if (options.circuitBreaker != nullptr && options.circuitBreaker->getState() == CircuitBreaker::State::open)
+        {
+            return fail (RetryErrorReason::circuitOpen);
+        }
+
+        if (options.budget != nullptr && ! options.budget->tryConsumeRetry())
+        {
+            return fail (RetryErrorReason::budgetExhausted);
+        }
+
+        return false;
+    }
+
+    bool fail (RetryErrorReason reason)
+    {
+        outcome.emplace (giveUp (options.observer, RetryError { reason, attempts, std::move (lastException) }));
+        return true;
+    }
+
+    ShouldRetryPredicate shouldRetryPredicate;
+    ShouldRetryExceptionPredicate shouldRetryExceptionPredicate;
+    int maxAttempts;
+    int attempts = 0;
+    Policy backoffPolicy;
+    Options options;
+    std::exception_ptr lastException;
+    std::optional<Result> outcome;
+    std::chrono::steady_clock::time_point attemptStarted;
+    std::chrono::steady_clock::duration longestAttempt {};
+    RetryDecision lastDecision = RetryDecision::retry();
+    bool finalAttempt = false;
+};
+
+/// Everything retry() does once its first attempt has asked to be retried. Kept out of
+/// retry() itself so the first-attempt path stays small enough to inline.
+template <typename ResultType, typename F,
+          typename ShouldRetryPredicate,
+          typename ShouldRetryExceptionPredicate,
+          typename Policy,
+          typename Observer,
+          typename Clock>
+expected<ResultType, RetryError> retryAfterFirstAttempt (F& func,
+                                                         ShouldRetryPredicate&& shouldRetryPredicate,
+                                                         ShouldRetryExceptionPredicate&& shouldRetryExceptionPredicate,
+                                                         int maxAttempts,
+                                                         Policy&& backoffPolicy,
+                                                         const stop_token& stopToken,
+                                                         const BasicRetryOptions<Observer, Clock>& options,
+                                                         Observer observer,
+                                                         std::exception_ptr firstException,
+                                                         std::chrono::steady_clock::time_point firstStarted,
+                                                         RetryDecision firstDecision)
+{
+    // The loop carries on with the observer the first attempt was reported to
+    auto loopOptions = options;
+    loopOptions.observer = std::move (observer);
+
+    RetryLoop<ResultType, ShouldRetryPredicate&&, ShouldRetryExceptionPredicate&&, std::decay_t<Policy>, Observer, Clock> loop (
+        std::forward<ShouldRetryPredicate> (shouldRetryPredicate),
+        std::forward<ShouldRetryExceptionPredicate> (shouldRetryExceptionPredicate),
+        maxAttempts,
+        std::move (backoffPolicy),
+        std::move (loopOptions));
+
+    auto finished = loop.resume (maxAttempts > 0 ? 1 : 0, std::move (firstException), firstStarted, firstDecision);
+
+    while (! finished)
+    {
+        if (options.clock.sleepFor (loop.nextDelay(), stopToken))
+        {
+            loop.cancel();
+            break;
+        }
+
+        finished = loop.runAttempt (func, stopToken);
+    }
+
+    return loop.takeResult();
+}
+
+} // namespace detail
+
+namespace retryxx
+{
+
+/// Executes a function with retry logic using exponential backoff and jitter.
+/// The function is retried based on both its return value and any exceptions thrown.
+/// @param func                             The function to execute and potentially retry, optionally taking a stop_token
+/// @param shouldRetryPredicate             Determines if result should trigger a retry, as a bool or a RetryDecision
+/// @param shouldRetryExceptionPredicate    Determines if exception should trigger a retry
+/// @param maxAttempts                      Maximum number of retry attempts
+/// @param backoffPolicy                    Timing configuration for retries
+/// @param stopToken                        Token for cooperative cancellation of retry operation
+/// @param options                          Optional shared collaborators such as a RetryBudget
+/// @returns                                Expected containing either the successful result or a RetryError
+template <Retryable F, typename ShouldRetryPredicate,
+                       typename ShouldRetryExceptionPredicate,
+                       BackoffStrategy Policy = BackoffPolicy,
+                       typename ResultType = detail::AttemptResult<F>,
+                       typename Observer = NoObserver,
+                       typename Clock = SteadyClock>
+expected<ResultType, RetryError> retry (F&& func,
+                                        ShouldRetryPredicate&& shouldRetryPredicate,
+                                        ShouldRetryExceptionPredicate&& shouldRetryExceptionPredicate,
+                                        int maxAttempts = 5,
+                                        Policy backoffPolicy = Policy{},
+                                        stop_token stopToken = stop_token{},
+                                        const BasicRetryOptions<Observer, Clock>& options = {})
+{
+    // The first attempt runs before any retry state is set up, so a call that succeeds
+    // straight away costs little more than invoking func directly.
+    Observer observer = options.observer;
+    std::exception_ptr firstException;
+    std::chrono::steady_clock::time_point started;
+    RetryDecision firstDecision = RetryDecision::retry();
+
+    if (maxAttempts > 0) [[likely]]
+    {
+        if (options.budget != nullptr)
+        {
+            options.budget->recordRequest();
+        }
+
+        if (options.circuitBreaker != nullptr && ! options.circuitBreaker->allowRequest (options.clock))
+        {
+            return detail::giveUp (observer, RetryError { RetryErrorReason::circuitOpen, 0, nullptr });
+        }
+
+        if (AdaptiveBackoffStrategy<Policy> || options.hasDeadline())
+        {
+            started = options.clock.now();
+
+            if (started >= options.deadline)
+            {
+                return detail::giveUp (observer, RetryError { RetryErrorReason::deadlineExceeded, 0, nullptr });
+            }
+        }
+
+        detail::notifyAttempt (observer, 1);
+
+#if RETRYXX_EXCEPTIONS
+        try
+#endif
+        {
+            ResultType result = detail::invokeTimedAttempt (func, stopToken, options.attemptTimeout);
+            firstDecision = shouldRetryPredicate (result);
+
+            if (! firstDecision.shouldRetry()) [[likely]]
+            {
+                if (options.circuitBreaker != nullptr)
+                {
+                    options.circuitBreaker->recordSuccess (options.clock);
+                }
+
+                if constexpr (AdaptiveBackoffStrategy<Policy>)
+                {
+                    backoffPolicy.recordOutcome (true, options.clock.now() - started);
+                }
+
+                detail::notifySuccess (observer, 1);
+                return expected<ResultType, RetryError> (std::move (result));
+            }
+
+            if (options.circuitBreaker != nullptr)
+            {
+                options.circuitBreaker->recordFailure (options.clock);
+            }
+
+            if constexpr (AdaptiveBackoffStrategy<Policy>)
+            {
+                backoffPolicy.recordOutcome (false, options.clock.now() - started);
+            }
+        }
+#if RETRYXX_EXCEPTIONS
+        catch (const detail::HandledException<ShouldRetryExceptionPredicate>& e)
+        {
+            if (options.circuitBreaker != nullptr)
+            {
+                options.circuitBreaker->recordFailure (options.clock);
+            }
+
+            if constexpr (AdaptiveBackoffStrategy<Policy>)
+            {
+                backoffPolicy.recordOutcome (false, options.clock.now() - started);
+            }
+
+            firstDecision = shouldRetryExceptionPredicate (e);
+
+            if (! firstDecision.shouldRetry())
+            {
+                return detail::giveUp (observer, RetryError { RetryErrorReason::nonRetryableException, 1, std::current_exception() });
+            }
+
+            firstException = std::current_exception();
+        }
+#endif
+    }
+
+    return detail::retryAfterFirstAttempt<ResultType> (func,
+                                                       std::forward<ShouldRetryPredicate> (shouldRetryPredicate),
+                                                       std::forward<ShouldRetryExceptionPredicate> (shouldRetryExceptionPredicate),
+                                                       maxAttempts,
+                                                       std::move (backoffPolicy),
+                                                       stopToken,
+                                                       options,
+                                                       std::move (observer),
+                                                       std::move (firstException),
+                                                       started,
+                                                       firstDecision);
+}
+
+/// Executes a function with retry logic until it succeeds or the deadline passes.
+/// Attempts are not counted: backoffs are shortened to fit the time left before the
+/// deadline, and the retry gives up with RetryErrorReason::deadlineExceeded rather than
+/// start an attempt it expects to overrun it.
+/// @param func                             The function to execute and potentially retry, optionally taking a stop_token
+/// @param shouldRetryPredicate             Determines if result should trigger a retry, as a bool or a RetryDecision
+/// @param shouldRetryExceptionPredicate    Determines if exception should trigger a retry
+/// @param deadline                         Absolute time by which the retry must be over
+/// @param backoffPolicy                    Timing configuration for retries
+/// @param stopToken                        Token for cooperative cancellation of retry operation
+/// @param options                          Optional shared collaborators such as a RetryBudget
+/// @returns                                Expected containing either the successful result or a RetryError
+template <Retryable F, typename ShouldRetryPredicate,
+                       typename ShouldRetryExceptionPredicate,
+                       BackoffStrategy Policy = BackoffPolicy,
+                       typename ResultType = detail::AttemptResult<F>,
+                       typename Observer = NoObserver,
+                       typename Clock = SteadyClock>
+expected<ResultType, RetryError> retry (F&& func,
+                                        ShouldRetryPredicate&& shouldRetryPredicate,
+                                        ShouldRetryExceptionPredicate&& shouldRetryExceptionPredicate,
+                                        std::chrono::steady_clock::time_point deadline,
+                                        Policy backoffPolicy = Policy{},
+                                        stop_token stopToken = stop_token{},
+                                        BasicRetryOptions<Observer, Clock> options = {})
+{
+    options.deadline = std::min (options.deadline, deadline);
+
+    return retry (std::forward<F> (func),
+                  std::forward<ShouldRetryPredicate> (shouldRetryPredicate),
+                  std::forward<ShouldRetryExceptionPredicate> (shouldRetryExceptionPredicate),
+                  std::numeric_limits<int>::max(),
+                  std::move (backoffPolicy),
+                  std::move (stopToken),
+                  options);
+}
+
+/// Executes a function returning an expected (or any type with has_value() and error())
+/// with retry logic, retrying on its error values instead of on exceptions. No exception is
+/// caught on this path, so a failing attempt costs no unwinding, and it is what retry()
+/// reduces to when exceptions are disabled. Anything an attempt does throw propagates.
+/// @param func                         The function to execute and potentially retry, optionally taking a stop_token
+/// @param shouldRetryErrorPredicate    Given the error value of a failed attempt, determines if it
+///                                     should trigger a retry, as a bool or a RetryDecision
+/// @param maxAttempts                  Maximum number of retry attempts
+/// @param backoffPolicy                Timing configuration for retries
+/// @param stopToken                    Token for cooperative cancellation of retry operation
+/// @param options                      Optional shared collaborators such as a RetryBudget
+/// @returns                            Expected containing either the last result, which holds an
+///                                     error only if the predicate declined to retry it, or a RetryError
+template <Retryable F, typename ShouldRetryErrorPredicate,
+                       BackoffStrategy Policy = BackoffPolicy,
+                       typename ResultType = detail::AttemptResult<F>,
+                       typename Observer = NoObserver,
+                       typename Clock = SteadyClock>
+    requires detail::ExpectedLike<ResultType>
+expected<ResultType, RetryError> retry_expected (F&& func,
+                                                 ShouldRetryErrorPredicate&& shouldRetryErrorPredicate,
+                                                 int maxAttempts = 5,
+                                                 Policy backoffPolicy = Policy{},
+                                                 stop_token stopToken = stop_token{},
+                                                 const BasicRetryOptions<Observer, Clock>& options = {})
+{
+    auto shouldRetryResult = [&shouldRetryErrorPredicate] (const ResultType& result)
+    {
+        return result.has_value() ? RetryDecision::stop() : RetryDecision (shouldRetryErrorPredicate (result.error()));
+    };
+
+    return retry (std::forward<F> (func),
+                  shouldRetryResult,
+                  detail::PropagateExceptions{},
+                  maxAttempts,
+                  std::move (backoffPolicy),
+                  std::move (stopToken),
+                  options);
+}
+
+} // namespace retryxx
+
+namespace retryxx::detail
+{
+
+inline bool interruptibleSleep (std::chrono::milliseconds duration, stop_token stopToken)
+{
+    if (! stopToken.stop_possible())
+    {
+        std::this_thread::sleep_for (duration);
+        return false;
+    }
+
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    bool stopped = false;
+
+    auto onStop = [&]
+    {
+        {
+            std::lock_guard lock (mutex);
+            stopped = true;
+        }
+
+        wakeup.notify_one();
+    };
+
+    stop_callback<decltype (onStop)> callback (stopToken, onStop);
+
+    std::unique_lock lock (mutex);
+    return wakeup.wait_for (lock, duration, [&] { return stopped; });
 }
 
 } // namespace detail
@@ -0,0 +1,313 @@
+//
+//  retryxx_retry_task.h
+//  retryxx
+//
+//  MIT License
+//
+//  Copyright (c) 2025 Jacob Sologub
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+#pragma once
+
+#include "retryxx_retry.h"
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace retryxx::detail
+{
+
+/// Everything one pending retry owns: the attempt, its RetryLoop, the stop token and
+/// what to do with the result.
+template <typename F, typename Loop, typename OnComplete>
+struct RetryTaskState
+{
+    /// @returns    True once the loop has finished and onComplete has been called
+    bool run()
+    {
+        if (started && stopToken.stop_requested())
+        {
+            cancel();
+            return true;
+        }
+
+        started = true;
+
+        if (loop.runAttempt (func, stopToken))
+        {
+            onComplete (loop.takeResult());
+            return true;
+        }
+
+        return false;
+    }
+
+    void cancel()
+    {
+        loop.cancel();
+        onComplete (loop.takeResult());
+    }
+
+    F func;
+    Loop loop;
+    OnComplete onComplete;
+    stop_token stopToken;
+    bool started = false;
+};
+
+/// Hand-rolled vtable for a RetryTaskState stored in a BasicRetryTask's buffer, either
+/// in place or, when it does not fit, as a pointer to a heap copy.
+struct RetryTaskOperations
+{
+    bool (*run) (void* storage);
+    std::chrono::milliseconds (*nextDelay) (void* storage);
+    void (*cancel) (void* storage);
+    void (*relocate) (void* from, void* to) noexcept;
+    void (*destroy) (void* storage) noexcept;
+};
+
+template <typename State, bool Inline>
+struct RetryTaskOperationsFor
+{
+    static State& get (void* storage) noexcept
+    {
+        if constexpr (Inline)
+        {
+            return *std::launder (static_cast<State*> (storage));
+        }
+        else
+        {
+            return **std::launder (static_cast<State**> (storage));
+        }
+    }
+
+    static void relocate (void* from, void* to) noexcept
+    {
+        if constexpr (Inline)
+        {
+            ::new (to) State (std::move (get (from)));
+            get (from).~State();
+        }
+        else
+        {
+            ::new (to) State* (std::exchange (*std::launder (static_cast<State**> (from)), nullptr));
+        }
+    }
+
+    static void destroy (void* storage) noexcept
+    {
+        if constexpr (Inline)
+        {
+            get (storage).~State();
+        }
+        else
+        {
+            delete *std::launder (static_cast<State**> (storage));
+        }
+    }
+
+    static constexpr RetryTaskOperations operations {
+        [] (void* storage) { return get (storage).run(); },
+        [] (void* storage) { return get (storage).loop.nextDelay(); },
+        [] (void* storage) { get (storage).cancel(); },
+        relocate,
+        destroy
+    };
+};
+
+} // namespace detail
+
+namespace retryxx
+{
+
+/// A pending retry of any callable, predicates and policy behind one move-only type, so
+/// that retries of different types can be queued in a plain array and driven one attempt
+/// at a time without a std::function or a heap allocation each.
+///
+/// The whole retry, including its RetryLoop, is stored inline when it fits in the Size
+/// bytes of the task, which a typical retry does with the default of four cache lines,
+/// and on the heap otherwise. Create one with makeRetryTask(). The task calls onComplete
+/// with the expected result once the retry finishes, and is empty from then on.
+template <std::size_t Size = 256>
+class BasicRetryTask
+{
+public:
+    static_assert (Size >= 2 * sizeof (void*) && Size % alignof (std::max_align_t) == 0,
+                   "Size must leave room for a pointer and keep the task aligned");
+
+    /// Bytes available for the retry's state before it is moved to the heap
+    static constexpr std::size_t inlineCapacity = Size - sizeof (void*);
+
+    BasicRetryTask() noexcept = default;
+
+    /// Constructs the task's State from args, in place if it fits and on the heap otherwise.
+    /// Low-level hook used by makeRetryTask.
+    template <typename State, typename... Args>
+    explicit BasicRetryTask (std::in_place_type_t<State>, Args&&... args)
+    {
+        constexpr bool fitsInline = sizeof (State) <= inlineCapacity
+                                 && alignof (State) <= alignof (std::max_align_t)
+                                 && std::is_nothrow_move_constructible_v<State>;
+
+        if constexpr (fitsInline)
+        {
+            ::new (static_cast<void*> (storage)) State { std::forward<Args> (args)... };
+        }
+        else
+        {
+            ::new (static_cast<void*> (storage)) State* (new State { std::forward<Args> (args)... });
+        }
+
+        operations = &detail::RetryTaskOperationsFor<State, fitsInline>::operations;
+    }
+
+    BasicRetryTask (BasicRetryTask&& other) noexcept
+      : operations (std::exchange (other.operations, nullptr))
+    {
+        if (operations != nullptr)
+        {
+            operations->relocate (other.storage, storage);
+        }
+    }
+
+    BasicRetryTask& operator= (BasicRetryTask&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+
+            if (other.operations != nullptr)
+            {
+                other.operations->relocate (other.storage, storage);
+                operations = std::exchange (other.operations, nullptr);
+            }
+        }
+
+        return *this;
+    }
+
+    ~BasicRetryTask()   { reset(); }
+
+    /// Returns true while the retry has not finished
+    explicit operator bool() const noexcept        { return operations != nullptr; }
+
+    /// Runs the next attempt, or finishes the retry as cancelled if stop has been requested
+    /// since the last one. Exceptions the retry does not handle propagate to the caller.
+    /// @returns    True once the retry has finished and onComplete has been called
+    bool run()
+    {
+        if (operations == nullptr)
+        {
+            return true;
+        }
+
+        if (! operations->run (storage))
+        {
+            return false;
+        }
+
+        reset();
+        return true;
+    }
+
+    /// Returns the backoff to wait before the next run(), after one that returned false
+    std::chrono::milliseconds nextDelay()
+    {
+        return operations != nullptr ? operations->nextDelay (storage) : std::chrono::milliseconds (0);
+    }
+
+    /// Finishes the retry as cancelled, calling onComplete, unless it has finished already
+    void cancel()
+    {
+        if (operations != nullptr)
+        {
+            operations->cancel (storage);
+            reset();
+        }
+    }
+
+private:
+    void reset() noexcept
+    {
+        if (auto* current = std::exchange (operations, nullptr))
+        {
+            current->destroy (storage);
+        }
+    }
+
+    alignas (std::max_align_t) std::byte storage[inlineCapacity];
+    const detail::RetryTaskOperations* operations = nullptr;
+};
+
+/// The default task, 256 bytes
+using RetryTask = BasicRetryTask<>;
+
+static_assert (sizeof (RetryTask) == 256);
+
+/// Packages a retry as a RetryTask that runs one attempt per run(), for schedulers that keep
+/// pending retries of many types side by side. Nothing runs until the first run().
+/// @param func                             The function to execute and potentially retry, optionally taking a stop_token
+/// @param shouldRetryPredicate             Determines if result should trigger a retry
+/// @param shouldRetryExceptionPredicate    Determines if exception should trigger a retry
+/// @param onComplete                       Called with the expected that retry() would have returned
+/// @param maxAttempts                      Maximum number of retry attempts
+/// @param backoffPolicy                    Timing configuration for retries
+/// @param stopToken                        Token for cooperative cancellation, checked before each attempt after the first
+/// @param options                          Optional shared collaborators such as a RetryBudget
+/// @returns                                The task, of Size bytes
+template <std::size_t Size = 256, Retryable F, typename ShouldRetryPredicate,
+                                               typename ShouldRetryExceptionPredicate,
+                                               typename OnComplete,
+                                               BackoffStrategy Policy = BackoffPolicy,
+                                               typename ResultType = detail::AttemptResult<std::decay_t<F>>,
+                                               typename Observer = NoObserver,
+                                               typename Clock = SteadyClock>
+BasicRetryTask<Size> makeRetryTask (F&& func,
+                                    ShouldRetryPredicate&& shouldRetryPredicate,
+                                    ShouldRetryExceptionPredicate&& shouldRetryExceptionPredicate,
+                                    OnComplete&& onComplete,
+                                    int maxAttempts = 5,
+                                    Policy backoffPolicy = Policy{},
+                                    stop_token stopToken = stop_token{},
+                                    const BasicRetryOptions<Observer, Clock>& options = {})
+{
+    using Loop = detail::RetryLoop<ResultType,
+                                   std::decay_t<ShouldRetryPredicate>,
+                                   std::decay_t<ShouldRetryExceptionPredicate>,
+                                   Policy,
+                                   Observer,
+                                   Clock>;
+
+    using State = detail::RetryTaskState<std::decay_t<F>, Loop, std::decay_t<OnComplete>>;
+
+    return BasicRetryTask<Size> (std::in_place_type<State>,
+                                 std::forward<F> (func),
+                                 Loop (std::forward<ShouldRetryPredicate> (shouldRetryPredicate),
+                                       std::forward<ShouldRetryExceptionPredicate> (shouldRetryExceptionPredicate),
+                                       maxAttempts,
+                                       std::move (backoffPolicy),
+                                       options),
+                                 std::forward<OnComplete> (onComplete),
+                                 std::move (stopToken));
+}
+
+} // namespace retryxx
@@ -0,0 +1,653 @@
+//
+//  retryxx_scheduler.h
+//  retryxx
+//
+//  MIT License
+//
+//  Copyright (c) 2025 Jacob Sologub
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+#pragma once
+
+#include "retryxx_retry.h"
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <future>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace retryxx::detail
+{
+
+/// Intrusive node for work queued on a RetryScheduler.
+/// A pending retry costs one of these links rather than a blocked thread.
+class TimerNode
+{
+public:
+    virtual ~TimerNode() = default;
+
+    /// Called on a scheduler thread once the node's deadline has passed
+    virtual void run() = 0;
+
+    /// Called instead of run() when the scheduler shuts down with the node still queued
+    virtual void abandon() = 0;
+
+private:
+    friend class TimerList;
+    friend class TimerWheel;
+
+    TimerNode* prev = nullptr;
+    TimerNode* next = nullptr;
+    std::uint64_t expiryTick = 0;
+    std::int8_t level = -1;
+    std::uint8_t slot = 0;
+};
+
+/// Doubly linked list of timer nodes used for wheel slots and the ready queue.
+class TimerList
+{
+public:
+    bool empty() const noexcept         { return head == nullptr; }
+
+    void pushBack (TimerNode* node) noexcept
+    {
+        node->prev = tail;
+        node->next = nullptr;
+        (tail != nullptr ? tail->next : head) = node;
+        tail = node;
+    }
+
+    TimerNode* popFront() noexcept
+    {
+        auto* node = head;
+        if (node != nullptr)
+        {
+            head = node->next;
+            (head != nullptr ? head->prev : tail) = nullptr;
+            node->next = nullptr;
+        }
+
+        return node;
+    }
+
+    TimerNode* popBack() noexcept
+    {
+        auto* node = tail;
+        if (node != nullptr)
+        {
+            tail = node->prev;
+            (tail != nullptr ? tail->next : head) = nullptr;
+            node->prev = nullptr;
+        }
+
+        return node;
+    }
+
+    void remove (TimerNode* node) noexcept
+    {
+        (node->prev != nullptr ? node->prev->next : head) = node->next;
+        (node->next != nullptr ? node->next->prev : tail) = node->prev;
+        node->prev = node->next = nullptr;
+    }
+
+    /// Moves every node from other to the back of this list
+    void splice (TimerList& other) noexcept
+    {
+        while (auto* node = other.popFront())
+        {
+            pushBack (node);
+        }
+    }
+
+private:
+    TimerNode* head = nullptr;
+    TimerNode* tail = nullptr;
+};
+
+/// Hierarchical timer wheel (Varghese & Lauck) with four levels of 256/64/64/64 slots.
+/// Insertion is O(1); each node is cascaded at most once per level on its way to expiry.
+/// With a 1 ms tick the wheel covers roughly 18 hours; later deadlines are parked in
+/// the outermost level and re-cascaded until they come into range.
+class TimerWheel
+{
+public:
+    /// Queues node to expire at the given tick, expiring on the next advance if it has already passed
+    void add (TimerNode* node, std::uint64_t expiryTick) noexcept
+    {
+        node->expiryTick = expiryTick;
+        auto tick = std::max (expiryTick, currentTick);
+        auto delta = tick - currentTick;
+
+        if (delta < innerSlots)
+        {
+            insert (0, tick & innerMask, node);
+        }
+        else if (delta < levelSpan (1))
+        {
+            insert (1, (tick >> levelShift (1)) & outerMask, node);
+        }
+        else if (delta < levelSpan (2))
+        {
+            insert (2, (tick >> levelShift (2)) & outerMask, node);
+        }
+        else
+        {
+            tick = currentTick + std::min (delta, levelSpan (3) - 1);
+            insert (3, (tick >> levelShift (3)) & outerMask, node);
+        }
+    }
+
+    /// Processes every tick up to and including targetTick, moving expired nodes into expired
+    void advance (std::uint64_t targetTick, TimerList& expired) noexcept
+    {
+        while (currentTick <= targetTick)
+        {
+            if (size() == 0)
+            {
+                currentTick = targetTick + 1;
+                return;
+            }
+
+            currentTick = std::min (nextEventTick(), targetTick + 1);
+            if (currentTick > targetTick)
+            {
+                return;
+            }
+
+            auto index = currentTick & innerMask;
+            for (int level = 1; level < numLevels && index == 0; ++level)
+            {
+                index = (currentTick >> levelShift (level)) & outerMask;
+                cascade (level, index);
+            }
+
+            auto& slot = slots[0][currentTick & innerMask];
+            while (auto* node = slot.popFront())
+            {
+                --counts[0];
+                node->level = -1;
+                expired.pushBack (node);
+            }
+
+            ++currentTick;
+        }
+    }
+
+    /// Unlinks node if it is queued in the wheel.
+    /// @returns    False if the node was not in the wheel
+    bool remove (TimerNode* node) noexcept
+    {
+        if (node->level < 0)
+        {
+            return false;
+        }
+
+        slotFor (node).remove (node);
+        --counts[node->level];
+        node->level = -1;
+        return true;
+    }
+
+    /// Returns the earliest tick at which advance() could have work to do
+    std::optional<std::uint64_t> nextExpiry() const noexcept
+    {
+        if (size() == 0)
+        {
+            return std::nullopt;
+        }
+
+        return nextEventTick();
+    }
+
+    /// Removes and returns every queued node, used when shutting down
+    void drain (TimerList& out) noexcept
+    {
+        for (int level = 0; level < numLevels; ++level)
+        {
+            for (auto& slot : slots[level])
+            {
+                while (auto* node = slot.popFront())
+                {
+                    node->level = -1;
+                    out.pushBack (node);
+                }
+            }
+
+            counts[level] = 0;
+        }
+    }
+
+    std::size_t size() const noexcept
+    {
+        return counts[0] + counts[1] + counts[2] + counts[3];
+    }
+
+private:
+    static constexpr int numLevels = 4;
+    static constexpr int innerBits = 8;
+    static constexpr int outerBits = 6;
+    static constexpr std::uint64_t innerSlots = std::uint64_t (1) << innerBits;
+    static constexpr std::uint64_t innerMask = innerSlots - 1;
+    static constexpr std::uint64_t outerMask = (std::uint64_t (1) << outerBits) - 1;
+
+    static constexpr int levelShift (int level) noexcept
+    {
+        return level == 0 ? 0 : innerBits + (level - 1) * outerBits;
+    }
+
+    /// Number of ticks covered by levels 0 through level
+    static constexpr std::uint64_t levelSpan (int level) noexcept
+    {
+        return std::uint64_t (1) << levelShift (level + 1);
+    }
+
+    void insert (int level, std::uint64_t index, TimerNode* node) noexcept
+    {
+        slots[level][index].pushBack (node);
+        node->level = static_cast<std::int8_t> (level);
+        node->slot = static_cast<std::uint8_t> (index);
+        ++counts[level];
+    }
+
+    TimerList& slotFor (const TimerNode* node) noexcept
+    {
+        return slots[node->level][node->slot];
+    }
+
+    void cascade (int level, std::uint64_t index) noexcept
+    {
+        auto& slot = slots[level][index];
+        while (auto* node = slot.popFront())
+        {
+            --counts[level];
+            node->level = -1;
+            add (node, node->expiryTick);
+        }
+    }
+
+    std::uint64_t nextEventTick() const noexcept
+    {
+        auto next = std::numeric_limits<std::uint64_t>::max();
+
+        if (counts[0] > 0)
+        {
+            for (std::uint64_t i = 0; i < innerSlots; ++i)
+            {
+                if (! slots[0][(currentTick + i) & innerMask].empty())
+                {
+                    next = currentTick + i;
+                    break;
+                }
+            }
+        }
+
+        if (counts[1] + counts[2] + counts[3] > 0)
+        {
+            next = std::min (next, (currentTick + innerMask) & ~innerMask);
+        }
+
+        return next;
+    }
+
+    std::array<std::array<TimerList, innerSlots>, numLevels> slots {};
+    std::array<std::size_t, numLevels> counts {};
+    std::uint64_t currentTick = 0;
+};
+
+/// TimerWheel driven by steady_clock: deadlines are given as delays from now and rounded
+/// up to a whole tick. This is the timer behind both RetryScheduler and RetryExecutor.
+/// It is not thread-safe, so its owner locks around every call.
+class TimerQueue
+{
+public:
+    /// @param tickInterval    Timer resolution, at least 1 ms
+    explicit TimerQueue (std::chrono::milliseconds tickInterval)
+      : tickDuration (std::max (tickInterval, std::chrono::milliseconds (1))),
+        startTime (std::chrono::steady_clock::now())
+    {
+    }
+
+    /// Queues node to expire once delay has elapsed
+    void add (TimerNode* node, std::chrono::milliseconds delay) noexcept
+    {
+        auto deadline = std::chrono::steady_clock::now() + delay - startTime;
+        wheel.add (node, static_cast<std::uint64_t> ((deadline + tickDuration - std::chrono::nanoseconds (1)) / tickDuration));
+    }
+
+    /// Moves every node whose deadline has passed into expired
+    void advance (TimerList& expired) noexcept
+    {
+        wheel.advance (static_cast<std::uint64_t> ((std::chrono::steady_clock::now() - startTime) / tickDuration), expired);
+    }
+
+    /// Returns the earliest time at which advance() could have work to do, if anything is queued
+    std::optional<std::chrono::steady_clock::time_point> nextExpiry() const noexcept
+    {
+        if (auto next = wheel.nextExpiry())
+        {
+            return startTime + tickDuration * static_cast<long long> (*next);
+        }
+
+        return std::nullopt;
+    }
+
+    bool remove (TimerNode* node) noexcept          { return wheel.remove (node); }
+    void drain (TimerList& out) noexcept            { wheel.drain (out); }
+    std::size_t size() const noexcept               { return wheel.size(); }
+
+private:
+    const std::chrono::steady_clock::duration tickDuration;
+    const std::chrono::steady_clock::time_point startTime;
+    TimerWheel wheel;
+};
+
+} // namespace detail
+
+namespace retryxx
+{
+
+/// Runs retry attempts on a small pool of threads and parks the backoff between
+/// attempts in a hierarchical timer wheel, so thousands of in-flight retries cost
+/// a few bytes each instead of a blocked thread and its stack.
+class RetryScheduler
+{
+public:
+    /// Creates a scheduler and starts its threads.
+    /// @param numThreads      Number of threads driving the wheel and running attempts (default: 1)
+    /// @param tickInterval    Timer resolution, deadlines are rounded up to a whole tick (default: 1 ms)
+    explicit RetryScheduler (int numThreads = 1,
+                             std::chrono::milliseconds tickInterval = std::chrono::milliseconds (1))
+      : timers (tickInterval)
+    {
+        for (int i = 0; i < std::max (numThreads, 1); ++i)
+        {
+            threads.emplace_back ([this] { runLoop(); });
+        }
+    }
+
+    /// Stops the threads. Retries that are still queued complete as cancelled.
+    ~RetryScheduler()
+    {
+        {
+            std::lock_guard lock (mutex);
+            stopping = true;
+        }
+
+        wakeup.notify_all();
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        detail::TimerList remaining;
+        remaining.splice (ready);
+        timers.drain (remaining);
+
+        while (auto* node = remaining.popFront())
+        {
+            node->abandon();
+        }
+    }
+
+    RetryScheduler (const RetryScheduler&) = delete;
+    RetryScheduler& operator= (const RetryScheduler&) = delete;
+
+    /// Returns the number of retries currently waiting out a backoff
+    std::size_t pending() const
+    {
+        std::lock_guard lock (mutex);
+        return timers.size();
+    }
+
+    /// Queues node to run on a scheduler thread as soon as one is free.
+    /// Low-level hook used by retry_async, the node must stay alive until run() or abandon().
+    void post (detail::TimerNode& node)
+    {
+        {
+            std::lock_guard lock (mutex);
+            ready.pushBack (&node);
+        }
+
+        wakeup.notify_one();
+    }
+
+    /// Queues node to run on a scheduler thread once delay has elapsed, or straight away
+    /// if stop has been requested on stopToken.
+    /// Low-level hook used by retry_async, the node must stay alive until run() or abandon().
+    void postAfter (detail::TimerNode& node, std::chrono::milliseconds delay, const stop_token& stopToken = stop_token{})
+    {
+        {
+            std::lock_guard lock (mutex);
+
+            if (stopToken.stop_requested())
+            {
+                ready.pushBack (&node);
+            }
+            else
+            {
+                timers.add (&node, delay);
+            }
+        }
+
+        wakeup.notify_one();
+    }
+
+    /// Moves node from the timer wheel to the front of the queue so it runs without
+    /// waiting for its deadline. Does nothing if the node is not waiting in the wheel.
+    /// @returns    True if the node was moved
+    bool expedite (detail::TimerNode& node)
+    {
+        {
+            std::lock_guard lock (mutex);
+            if (! timers.remove (&node))
+            {
+                return false;
+            }
+
+            ready.pushBack (&node);
+        }
+
+        wakeup.notify_one();
+        return true;
+    }
+
+    /// Takes node out of the timer wheel without running it, after which the caller owns it
+    /// again. Does nothing if the node is not waiting in the wheel.
+    /// @returns    True if the node was removed
+    bool cancel (detail::TimerNode& node)
+    {
+        std::lock_guard lock (mutex);
+        return timers.remove (&node);
+    }
+
+    /// Returns the number of threads running attempts
+    int getNumThreads() const noexcept     { return static_cast<int> (threads.size()); }
+
+private:
+    void runLoop()
+    {
+        std::unique_lock lock (mutex);
+
+        while (! stopping)
+        {
+            timers.advance (ready);
+
+            if (auto* node = ready.popFront())
+            {
+                lock.unlock();
+                node->run();
+                lock.lock();
+                continue;
+            }
+
+            if (auto next = timers.nextExpiry())
+            {
+                wakeup.wait_until (lock, *next);
+            }
+            else
+            {
+                wakeup.wait (lock);
+            }
+        }
+    }
+
+    mutable std::mutex mutex;
+    std::condition_variable wakeup;
+    detail::TimerQueue timers;
+    detail::TimerList ready;
+    bool stopping = false;
+    std::vector<std::thread> threads;
+};
+
+} // namespace retryxx
+
+namespace retryxx::detail
+{
+
+/// Heap-allocated state of one asynchronous retry. It owns the function, predicates
+/// and policy, re-queues itself on the scheduler between attempts and deletes itself
+/// once the promise has been fulfilled. Scheduler is anything with RetryScheduler's
+/// postAfter() and expedite(), such as RetryScheduler itself or RetryExecutor.
+template <typename F, typename Loop, typename Scheduler = RetryScheduler>
+class AsyncRetryOperation final : public TimerNode
+{
+public:
+    AsyncRetryOperation (Scheduler& scheduler,
+                         F func,
+                         Loop loop,
+                         stop_token stopToken)
+      : scheduler (scheduler),
+        func (std::move (func)),
+        loop (std::move (loop)),
+        stopToken (std::move (stopToken))
+    {
+        onStop.emplace (this->stopToken, Wake { this });
+    }
+
+    std::future<typename Loop::Result> getFuture()  { return promise.get_future(); }
+
+    void run() override
+    {
+        if (started && stopToken.stop_requested())
+        {
+            loop.cancel();
+            return complete();
+        }
+
+        started = true;
+
+        if (loop.runAttempt (func, stopToken))
+        {
+            return complete();
+        }
+
+        scheduler.postAfter (*this, loop.nextDelay(), stopToken);
+    }
+
+    void abandon() override
+    {
+        loop.cancel();
+        complete();
+    }
+
+private:
+    /// Cuts the backoff short once stop is requested, so cancellation completes the
+    /// future promptly instead of at the attempt's deadline
+    struct Wake
+    {
+        void operator()() const noexcept    { operation->scheduler.expedite (*operation); }
+
+        AsyncRetryOperation* operation;
+    };
+
+    void complete()
+    {
+        promise.set_value (loop.takeResult());
+        delete this;
+    }
+
+    Scheduler& scheduler;
+    F func;
+    Loop loop;
+    stop_token stopToken;
+    std::promise<typename Loop::Result> promise;
+    bool started = false;
+    std::optional<stop_callback<Wake>> onStop;
+};
+
+} // namespace detail
+
+namespace retryxx
+{
+
+/// Asynchronous counterpart of retry(). The first attempt is queued immediately and
+/// every later attempt is queued on the scheduler's timer wheel at its backoff deadline,
+/// so no thread is blocked while waiting. Attempts run on the scheduler's threads.
+/// @param scheduler                        Scheduler that runs the attempts, must outlive the retry
+/// @param func                             The function to execute and potentially retry, optionally taking a stop_token
+/// @param shouldRetryPredicate             Determines if result should trigger a retry
+/// @param shouldRetryExceptionPredicate    Determines if exception should trigger a retry
+/// @param maxAttempts                      Maximum number of retry attempts
+/// @param backoffPolicy                    Timing configuration for retries
+/// @param stopToken                        Token for cooperative cancellation, ends a pending backoff immediately
+/// @param options                          Optional shared collaborators such as a RetryBudget
+/// @returns                                Future of the expected that retry() would have returned
+template <Retryable F, typename ShouldRetryPredicate,
+                       typename ShouldRetryExceptionPredicate,
+                       BackoffStrategy Policy = BackoffPolicy,
+                       typename ResultType = detail::AttemptResult<std::decay_t<F>>,
+                       typename Observer = NoObserver>
+std::future<expected<ResultType, RetryError>> retry_async (RetryScheduler& scheduler,
+                                                           F&& func,
+                                                           ShouldRetryPredicate&& shouldRetryPredicate,
+                                                           ShouldRetryExceptionPredicate&& shouldRetryExceptionPredicate,
+                                                           int maxAttempts = 5,
+                                                           Policy backoffPolicy = Policy{},
+                                                           stop_token stopToken = stop_token{},
+                                                           const BasicRetryOptions<Observer>& options = {})
+{
+    using Loop = detail::RetryLoop<ResultType,
+                                   std::decay_t<ShouldRetryPredicate>,
+                                   std::decay_t<ShouldRetryExceptionPredicate>,
+                                   Policy,
+                                   Observer>;
+
+    auto* operation = new detail::AsyncRetryOperation<std::decay_t<F>, Loop> (
+        scheduler,
+        std::forward<F> (func),
+        Loop (std::forward<ShouldRetryPredicate> (shouldRetryPredicate),
+              std::forward<ShouldRetryExceptionPredicate> (shouldRetryExceptionPredicate),
+              maxAttempts,
+              std::move (backoffPolicy),
+              options),
+        std::move (stopToken));
+
+    auto future = operation->getFuture();
+    scheduler.post (*operation);
+    return future;
+}
+
+} // namespace retryxx
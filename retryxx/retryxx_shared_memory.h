@@ -0,0 +1,185 @@
+//
+//  retryxx_shared_memory.h
+//  retryxx
+//
+//  MIT License
+//
+//  Copyright (c) 2025 Jacob Sologub
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+#pragma once
+
+#include "retryxx_retry.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace retryxx
+{
+
+/// A T that lives in a named POSIX shared memory segment, so that every process on the
+/// host that opens the same name sees the same object. This is how worker processes share
+/// a RetryBudget or CircuitBreaker and back off together without any IPC round trip: both
+/// are lock-free atomics in a fixed, cache-line padded layout with no pointers.
+///
+/// The first process to open a name constructs the object from args; later ones attach to
+/// it and ignore theirs. The object outlives the processes using it until remove() is
+/// called, so it is never destroyed. Every process must use the same build of T, which is
+/// checked by size and alignment when attaching.
+///
+/// A process that attaches while the object is being constructed waits for up to
+/// attachTimeout. If the creator died part way, the segment never becomes ready and every
+/// later open fails with ETIMEDOUT until remove() is called and the object recreated.
+template <typename T>
+class SharedMemoryObject
+{
+public:
+    static_assert (std::is_standard_layout_v<T> && std::is_trivially_destructible_v<T>,
+                   "only plain atomic state can be shared between processes");
+    static_assert (std::atomic<std::uint32_t>::is_always_lock_free && std::atomic<std::uint64_t>::is_always_lock_free,
+                   "atomics in shared memory must be lock-free to work across processes");
+
+    /// Opens or creates the segment called name and the T inside it.
+    /// @param name     Name of the segment, starting with a slash, e.g. "/payments.budget"
+    /// @param args     Constructor arguments, used only by the process that creates the object
+    /// @throws         std::system_error if the segment cannot be opened, holds a different layout
+    ///                 or is not constructed within attachTimeout, or aborts when built without exceptions
+    template <typename... Args>
+    explicit SharedMemoryObject (const std::string& name, Args&&... args)
+    {
+        auto fd = ::shm_open (name.c_str(), O_CREAT | O_RDWR, 0600);
+        if (fd < 0)
+        {
+            fail (errno, "shm_open " + name);
+        }
+
+        struct stat info {};
+        if (::fstat (fd, &info) != 0
+            || (info.st_size != 0 && info.st_size != static_cast<off_t> (sizeof (Segment)))
+            || (info.st_size == 0 && ::ftruncate (fd, sizeof (Segment)) != 0))
+        {
+            auto error = info.st_size != 0 ? EINVAL : errno;
+            ::close (fd);
+            fail (error, "shm segment " + name);
+        }
+
+        auto* address = ::mmap (nullptr, sizeof (Segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close (fd);
+
+        if (address == MAP_FAILED)
+        {
+            fail (errno, "mmap " + name);
+        }
+
+        segment = static_cast<Segment*> (address);
+        std::uint32_t state = uninitialised;
+
+        if (segment->state.compare_exchange_strong (state, constructing, std::memory_order_acquire))
+        {
+            ::new (segment->storage) T (std::forward<Args> (args)...);
+            segment->layout = layoutTag;
+            segment->state.store (ready, std::memory_order_release);
+            return;
+        }
+
+        auto giveUpAt = std::chrono::steady_clock::now() + attachTimeout;
+
+        while (segment->state.load (std::memory_order_acquire) != ready)
+        {
+            if (std::chrono::steady_clock::now() >= giveUpAt)
+            {
+                ::munmap (segment, sizeof (Segment));
+                fail (ETIMEDOUT, "shm segment " + name + " was never constructed");
+            }
+
+            std::this_thread::sleep_for (std::chrono::microseconds (100));
+        }
+
+        if (segment->layout != layoutTag)
+        {
+            ::munmap (segment, sizeof (Segment));
+            fail (EINVAL, "shm segment " + name);
+        }
+    }
+
+    ~SharedMemoryObject()
+    {
+        ::munmap (segment, sizeof (Segment));
+    }
+
+    SharedMemoryObject (const SharedMemoryObject&) = delete;
+    SharedMemoryObject& operator= (const SharedMemoryObject&) = delete;
+
+    /// Returns the shared object, e.g. for { .budget = &budget.get() }
+    T& get() const noexcept             { return *std::launder (reinterpret_cast<T*> (segment->storage)); }
+    T* operator->() const noexcept      { return &get(); }
+    T& operator*() const noexcept       { return get(); }
+
+    /// Removes the segment name, so the next process to open it creates a fresh object.
+    /// Processes that still have it open keep using the old one until they close it.
+    static bool remove (const std::string& name) noexcept
+    {
+        return ::shm_unlink (name.c_str()) == 0;
+    }
+
+    /// How long to wait for another process to finish constructing the object
+    static constexpr std::chrono::milliseconds attachTimeout { 1000 };
+
+private:
+    [[noreturn]] static void fail (int error, const std::string& what)
+    {
+#if RETRYXX_EXCEPTIONS
+        throw std::system_error (error, std::generic_category(), what);
+#else
+        (void) error;
+        (void) what;
+        std::abort();
+#endif
+    }
+
+    static constexpr std::uint32_t uninitialised = 0;
+    static constexpr std::uint32_t constructing = 1;
+    static constexpr std::uint32_t ready = 2;
+    static constexpr std::uint64_t layoutTag = (std::uint64_t (sizeof (T)) << 32) | alignof (T);
+
+    // A new segment reads as zeros, i.e. uninitialised; the object starts on its own cache line
+    struct Segment
+    {
+        std::atomic<std::uint32_t> state;
+        std::uint64_t layout;
+        alignas (std::max<std::size_t> (alignof (T), 64)) std::byte storage[sizeof (T)];
+    };
+
+    Segment* segment = nullptr;
+};
+
+} // namespace retryxx
@@ -0,0 +1,233 @@
+//
+//  retryxx_single_flight.h
+//  retryxx
+//
+//  MIT License
+//
+//  Copyright (c) 2025 Jacob Sologub
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+#pragma once
+
+#include "retryxx_retry.h"
+
+#include <concepts>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace retryxx
+{
+
+/// Collapses concurrent retries of the same key into a single retry loop.
+/// The first caller for a key becomes the leader and runs retry() itself; callers that
+/// arrive with the same key while it is running wait for it and receive a copy of its
+/// expected result, so the result type must be copyable. Once the leader finishes the key
+/// is released, so the next caller starts a fresh retry.
+///
+/// Waiters share the leader's func, predicates, policy, stop token and options: if the
+/// leader is cancelled every waiter receives the cancellation. A waiter whose own stop
+/// token fires stops waiting and receives RetryErrorReason::cancelled. Callers that use
+/// the same key with a different result type are not coalesced with each other.
+template <typename Key, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+class SingleFlightRetry
+{
+public:
+    SingleFlightRetry() = default;
+    SingleFlightRetry (const SingleFlightRetry&) = delete;
+    SingleFlightRetry& operator= (const SingleFlightRetry&) = delete;
+
+    /// Executes func with retry logic unless a retry for key is already running, in
+    /// which case it waits for that retry and returns its result.
+    /// @param key                              Identifies retries that may be coalesced
+    /// @param func                             The function to execute and potentially retry, optionally taking a stop_token
+    /// @param shouldRetryPredicate             Determines if result should trigger a retry
+    /// @param shouldRetryExceptionPredicate    Determines if exception should trigger a retry
+    /// @param maxAttempts                      Maximum number of retry attempts
+    /// @param backoffPolicy                    Timing configuration for retries
+    /// @param stopToken                        Token for cooperative cancellation of the retry or wait
+    /// @param options                          Optional shared collaborators such as a RetryBudget
+    /// @returns                                Expected containing either the successful result or a RetryError
+    template <Retryable F, typename ShouldRetryPredicate,
+                           typename ShouldRetryExceptionPredicate,
+                           BackoffStrategy Policy = BackoffPolicy,
+                           typename ResultType = detail::AttemptResult<F>,
+                           typename Observer = NoObserver,
+                           typename Clock = SteadyClock>
+        requires std::copy_constructible<ResultType>
+    expected<ResultType, RetryError> retry (const Key& key,
+                                            F&& func,
+                                            ShouldRetryPredicate&& shouldRetryPredicate,
+                                            ShouldRetryExceptionPredicate&& shouldRetryExceptionPredicate,
+                                            int maxAttempts = 5,
+                                            Policy backoffPolicy = Policy{},
+                                            stop_token stopToken = stop_token{},
+                                            const BasicRetryOptions<Observer, Clock>& options = {})
+    {
+        std::shared_ptr<Flight<ResultType>> flight;
+        bool leader = false;
+
+        {
+            std::lock_guard lock (mutex);
+            auto& slot = flights[key];
+
+            if (slot == nullptr)
+            {
+                slot = std::make_shared<Flight<ResultType>>();
+                leader = true;
+            }
+
+            if (slot->resultType == typeTag<ResultType>())
+            {
+                flight = std::static_pointer_cast<Flight<ResultType>> (slot);
+            }
+        }
+
+        if (flight == nullptr)
+        {
+            return retryxx::retry (std::forward<F> (func),
+                                   std::forward<ShouldRetryPredicate> (shouldRetryPredicate),
+                                   std::forward<ShouldRetryExceptionPredicate> (shouldRetryExceptionPredicate),
+                                   maxAttempts,
+                                   std::move (backoffPolicy),
+                                   std::move (stopToken),
+                                   options);
+        }
+
+        if (! leader)
+        {
+            return flight->wait (stopToken);
+        }
+
+#if RETRYXX_EXCEPTIONS
+        try
+#endif
+        {
+            auto result = retryxx::retry (std::forward<F> (func),
+                                          std::forward<ShouldRetryPredicate> (shouldRetryPredicate),
+                                          std::forward<ShouldRetryExceptionPredicate> (shouldRetryExceptionPredicate),
+                                          maxAttempts,
+                                          std::move (backoffPolicy),
+                                          std::move (stopToken),
+                                          options);
+            release (key);
+            flight->complete (result, nullptr);
+            return result;
+        }
+#if RETRYXX_EXCEPTIONS
+        catch (...)
+        {
+            release (key);
+            flight->complete (std::nullopt, std::current_exception());
+            throw;
+        }
+#endif
+    }
+
+    /// Returns the number of keys with a retry currently running
+    std::size_t inFlight() const
+    {
+        std::lock_guard lock (mutex);
+        return flights.size();
+    }
+
+private:
+    /// Identifies a result type without RTTI: every instantiation has its own address
+    template <typename ResultType>
+    static const void* typeTag() noexcept
+    {
+        static constexpr char tag = 0;
+        return &tag;
+    }
+
+    struct FlightBase
+    {
+        explicit FlightBase (const void* type) noexcept : resultType (type) {}
+        virtual ~FlightBase() = default;
+
+        const void* const resultType;
+    };
+
+    template <typename ResultType>
+    struct Flight : FlightBase
+    {
+        Flight() noexcept : FlightBase (typeTag<ResultType>()) {}
+
+        void complete (std::optional<expected<ResultType, RetryError>> value, std::exception_ptr error)
+        {
+            {
+                std::lock_guard lock (mutex);
+                result = std::move (value);
+                exception = std::move (error);
+                finished = true;
+            }
+
+            done.notify_all();
+        }
+
+        expected<ResultType, RetryError> wait (const stop_token& stopToken)
+        {
+            auto onStop = [this]
+            {
+                std::lock_guard lock (mutex);
+                done.notify_all();
+            };
+
+            stop_callback<decltype (onStop)> callback (stopToken, onStop);
+
+            std::unique_lock lock (mutex);
+            done.wait (lock, [&] { return finished || stopToken.stop_requested(); });
+
+            if (! finished)
+            {
+                return unexpected (RetryError { RetryErrorReason::cancelled, 0, nullptr });
+            }
+
+#if RETRYXX_EXCEPTIONS
+            if (exception)
+            {
+                std::rethrow_exception (exception);
+            }
+#endif
+
+            return *result;
+        }
+
+        std::mutex mutex;
+        std::condition_variable done;
+        std::optional<expected<ResultType, RetryError>> result;
+        std::exception_ptr exception;
+        bool finished = false;
+    };
+
+    void release (const Key& key)
+    {
+        std::lock_guard lock (mutex);
+        flights.erase (key);
+    }
+
+    mutable std::mutex mutex;
+    std::unordered_map<Key, std::shared_ptr<FlightBase>, Hash, KeyEqual> flights;
+};
+
+} // namespace retryxx
@@ -0,0 +1,142 @@
+//
+//  retryxx_static_policy.h
+//  retryxx
+//
+//  MIT License
+//
+//  Copyright (c) 2025 Jacob Sologub
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+#pragma once
+
+#include "retryxx_retry.h"
+
+#include <array>
+
+namespace retryxx
+{
+
+/// Backoff policy whose whole configuration is fixed at compile time, for call sites that
+/// use constants anyway. The delays before jitter form a constexpr schedule, so getDelay()
+/// is one table lookup plus the jitter draw, and with NoJitter it folds to a constant.
+/// Durations are given in milliseconds, as std::chrono::duration cannot be a template argument.
+/// @tparam MaxAttempts             Maximum number of attempts, used by retry<Policy>()
+/// @tparam InitialMilliseconds     Delay before the first retry
+/// @tparam Multiplier              Growth factor for each further retry
+/// @tparam MaxMilliseconds         Cap on any delay
+template <int MaxAttempts,
+          long long InitialMilliseconds,
+          double Multiplier,
+          long long MaxMilliseconds,
+          typename Jitter = FullJitter,
+          typename Rng = SplitMix64>
+struct StaticBackoffPolicy
+{
+    static_assert (MaxAttempts > 0, "a retry needs at least one attempt");
+
+    using RandomEngine = Rng;
+    using JitterStrategy = Jitter;
+
+    static constexpr int maxAttempts = MaxAttempts;
+    static constexpr std::chrono::milliseconds initialDelay { InitialMilliseconds };
+    static constexpr double multiplier = Multiplier;
+    static constexpr std::chrono::milliseconds maxDelay { MaxMilliseconds };
+
+    /// Delay before retry i + 1 before jitter is applied: initialDelay * multiplier^i saturated at maxDelay
+    static constexpr auto schedule = []
+    {
+        std::array<long long, std::max (MaxAttempts - 1, 1)> delays {};
+        auto delay = static_cast<double> (InitialMilliseconds);
+
+        for (auto& entry : delays)
+        {
+            entry = delay < static_cast<double> (MaxMilliseconds) ? static_cast<long long> (std::max (delay, 0.0))
+                                                                  : std::max (MaxMilliseconds, 0LL);
+            delay *= Multiplier;
+        }
+
+        return delays;
+    }();
+
+    /// Returns the delay before jitter for the given retry attempt, the last one in the schedule past its end.
+    /// @param attempt   The retry attempt number (1-based)
+    static constexpr std::chrono::milliseconds getBaseDelay (int attempt) noexcept
+    {
+        auto index = static_cast<std::size_t> (std::clamp (attempt, 1, static_cast<int> (schedule.size())) - 1);
+        return std::chrono::milliseconds (schedule[index]);
+    }
+
+    /// Calculates the randomized delay for the given retry attempt.
+    /// @param attempt   The retry attempt number (1-based)
+    /// @returns         The delay chosen by the Jitter strategy, never more than maxDelay
+    std::chrono::milliseconds getDelay (int attempt) const
+    {
+        return std::chrono::milliseconds (jitter (attempt,
+                                                  getBaseDelay (attempt).count(),
+                                                  std::max (InitialMilliseconds, 0LL),
+                                                  std::max (MaxMilliseconds, 0LL),
+                                                  detail::threadLocalRng<Rng>()));
+    }
+
+private:
+    [[no_unique_address]] mutable Jitter jitter;
+};
+
+/// A policy that carries its own attempt count, such as StaticBackoffPolicy
+template <typename P>
+concept StaticBackoffStrategy = BackoffStrategy<P> && std::default_initializable<P> && requires
+{
+    { P::maxAttempts } -> std::convertible_to<int>;
+};
+
+static_assert (StaticBackoffStrategy<StaticBackoffPolicy<3, 50, 2.0, 1000>>);
+static_assert (std::is_trivially_copyable_v<StaticBackoffPolicy<3, 50, 2.0, 1000>>);
+
+/// Executes a function with retry logic configured entirely by Policy, e.g.
+/// retry<StaticBackoffPolicy<3, 50, 2.0, 1000>> (func, shouldRetry, shouldRetryException).
+/// @param func                             The function to execute and potentially retry, optionally taking a stop_token
+/// @param shouldRetryPredicate             Determines if result should trigger a retry, as a bool or a RetryDecision
+/// @param shouldRetryExceptionPredicate    Determines if exception should trigger a retry
+/// @param stopToken                        Token for cooperative cancellation of retry operation
+/// @param options                          Optional shared collaborators such as a RetryBudget
+/// @returns                                Expected containing either the successful result or a RetryError
+template <StaticBackoffStrategy Policy, Retryable F,
+                                        typename ShouldRetryPredicate,
+                                        typename ShouldRetryExceptionPredicate,
+                                        typename ResultType = detail::AttemptResult<F>,
+                                        typename Observer = NoObserver,
+                                        typename Clock = SteadyClock>
+expected<ResultType, RetryError> retry (F&& func,
+                                        ShouldRetryPredicate&& shouldRetryPredicate,
+                                        ShouldRetryExceptionPredicate&& shouldRetryExceptionPredicate,
+                                        stop_token stopToken = stop_token{},
+                                        const BasicRetryOptions<Observer, Clock>& options = {})
+{
+    return retry (std::forward<F> (func),
+                  std::forward<ShouldRetryPredicate> (shouldRetryPredicate),
+                  std::forward<ShouldRetryExceptionPredicate> (shouldRetryExceptionPredicate),
+                  static_cast<int> (Policy::maxAttempts),
+                  Policy{},
+                  std::move (stopToken),
+                  options);
+}
+
+} // namespace retryxx
@@ -0,0 +1,277 @@
+//
+//  retryxx_trace.h
+//  retryxx
+//
+//  MIT License
+//
+//  Copyright (c) 2025 Jacob Sologub
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+#pragma once
+
+#include "retryxx_retry.h"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+
+namespace retryxx
+{
+
+/// One entry of a TraceBuffer: how a single attempt of a sampled retry ended
+struct AttemptRecord
+{
+    enum class Outcome : std::uint8_t
+    {
+        retrying,       ///< The attempt failed and the retry is backing off for delayMilliseconds
+        succeeded,      ///< The attempt's result was accepted
+        gaveUp          ///< The retry gave up after the attempt, for reason
+    };
+
+    std::int64_t timestamp;             ///< When the attempt ended, in nanoseconds since the retry clock's epoch
+    std::uint64_t traceId;              ///< Shared by every record of the same retry
+    std::int32_t attempt;               ///< 1-based attempt number, 0 if the retry gave up before attempting
+    std::int32_t delayMilliseconds;     ///< Backoff chosen after the attempt, for Outcome::retrying
+    Outcome outcome;
+    RetryErrorReason reason;            ///< Why the retry gave up, for Outcome::gaveUp
+};
+
+static_assert (sizeof (AttemptRecord) <= 32 && std::is_trivially_copyable_v<AttemptRecord>);
+
+class TraceBuffer;
+
+/// Observer that writes the attempts of one retry to a TraceBuffer. Get one from
+/// TraceBuffer::observe() for every retry, as that is where the retry is sampled and
+/// given its trace ID: BasicRetryOptions<TraceObserver> { .observer = traces.observe() }.
+/// Records are stamped with Clock, which should be the clock in the retry's options, e.g.
+/// BasicRetryOptions<BasicTraceObserver<VirtualClock>, VirtualClock> with observe (clock).
+template <RetryClock Clock = SteadyClock>
+class BasicTraceObserver
+{
+public:
+    /// Creates an observer that records nothing
+    BasicTraceObserver() = default;
+
+    /// Returns true if this retry's attempts are recorded
+    bool isSampled() const noexcept     { return buffer != nullptr; }
+
+    void onBackoff (int attempt, std::chrono::milliseconds delay) const noexcept;
+    void onSuccess (int attempts) const noexcept;
+    void onGiveUp (const RetryError& error) const noexcept;
+
+private:
+    friend class TraceBuffer;
+
+    BasicTraceObserver (TraceBuffer* traceBuffer, std::uint64_t id, Clock traceClock) noexcept
+      : buffer (traceBuffer),
+        traceId (id),
+        clock (std::move (traceClock))
+    {
+    }
+
+    void record (std::int32_t attempt, std::int32_t delay, AttemptRecord::Outcome outcome, RetryErrorReason reason) const noexcept;
+
+    TraceBuffer* buffer = nullptr;
+    std::uint64_t traceId = 0;
+    [[no_unique_address]] Clock clock {};
+};
+
+/// The observer for retries timed by the default SteadyClock
+using TraceObserver = BasicTraceObserver<>;
+
+/// Bounded lock-free ring of AttemptRecords written by any number of retrying threads
+/// and drained by one consumer, e.g. an exporter to a tracing system. Writing a record is
+/// a clock read, one compare-and-swap and a release store into a preallocated slot, and
+/// retries that are not sampled record nothing at all. When the ring is full new records
+/// are dropped and counted rather than waiting for the consumer.
+class TraceBuffer
+{
+public:
+    /// Creates a buffer and allocates all of its slots up front.
+    /// @param capacity         Records held before new ones are dropped, rounded up to a power of two
+    /// @param sampleEvery      Record one retry in this many (default: every retry)
+    explicit TraceBuffer (std::size_t capacity = 4096, std::uint32_t sampleEvery = 1)
+      : mask (std::bit_ceil (std::max<std::size_t> (capacity, 2)) - 1),
+        slots (std::make_unique<Slot[]> (mask + 1)),
+        sampleEvery (std::max<std::uint32_t> (sampleEvery, 1))
+    {
+        for (std::size_t i = 0; i <= mask; ++i)
+        {
+            slots[i].sequence.store (i, std::memory_order_relaxed);
+        }
+    }
+
+    TraceBuffer (const TraceBuffer&) = delete;
+    TraceBuffer& operator= (const TraceBuffer&) = delete;
+
+    /// Returns the observer for one retry, which records it only if it is sampled. Retries
+    /// are counted on the calling thread's shard of this buffer, so threads observing at
+    /// once rarely write to the same cache line.
+    /// @param clock    Clock the records are stamped with, the one in the retry's options
+    template <RetryClock Clock = SteadyClock>
+    BasicTraceObserver<Clock> observe (Clock clock = Clock{}) noexcept
+    {
+        if (sampleEvery > 1)
+        {
+            auto& counter = sampleCounters[localShard()].retries;
+
+            if (counter.fetch_add (1, std::memory_order_relaxed) % sampleEvery != 0)
+            {
+                return {};
+            }
+        }
+
+        return BasicTraceObserver<Clock> (this, nextTraceId.fetch_add (1, std::memory_order_relaxed), std::move (clock));
+    }
+
+    /// Passes the records written so far to callback, oldest first. Only one thread may
+    /// drain at a time; writers carry on meanwhile.
+    /// @param callback     Called with each const AttemptRecord&
+    /// @param maxRecords   Stops after this many records
+    /// @returns            The number of records passed to callback
+    template <typename Callback>
+    std::size_t drain (Callback&& callback, std::size_t maxRecords = std::numeric_limits<std::size_t>::max())
+    {
+        std::size_t drained = 0;
+
+        for (; drained < maxRecords; ++drained)
+        {
+            auto& slot = slots[head & mask];
+
+            if (slot.sequence.load (std::memory_order_acquire) != head + 1)
+            {
+                break;
+            }
+
+            auto record = slot.record;
+            slot.sequence.store (head + mask + 1, std::memory_order_release);
+            ++head;
+            callback (record);
+        }
+
+        return drained;
+    }
+
+    /// Returns the number of records dropped because the buffer was full
+    std::uint64_t dropped() const noexcept      { return droppedRecords.load (std::memory_order_relaxed); }
+
+    /// Returns the number of records the buffer holds before it starts dropping them
+    std::size_t capacity() const noexcept       { return mask + 1; }
+
+    /// Appends a record, or counts it as dropped if the buffer is full
+    void push (const AttemptRecord& record) noexcept
+    {
+        auto position = tail.load (std::memory_order_relaxed);
+
+        for (;;)
+        {
+            auto& slot = slots[position & mask];
+            auto sequence = slot.sequence.load (std::memory_order_acquire);
+            auto difference = static_cast<std::int64_t> (sequence - position);
+
+            if (difference == 0)
+            {
+                if (tail.compare_exchange_weak (position, position + 1, std::memory_order_relaxed))
+                {
+                    slot.record = record;
+                    slot.sequence.store (position + 1, std::memory_order_release);
+                    return;
+                }
+            }
+            else if (difference < 0)
+            {
+                droppedRecords.fetch_add (1, std::memory_order_relaxed);
+                return;
+            }
+            else
+            {
+                position = tail.load (std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    /// A slot is free for the writer at position when its sequence equals position, and
+    /// holds that writer's record once it reaches position + 1
+    struct Slot
+    {
+        std::atomic<std::uint64_t> sequence { 0 };
+        AttemptRecord record {};
+    };
+
+    static constexpr std::size_t numShards = 16;
+
+    struct alignas (64) SampleCounter
+    {
+        std::atomic<std::uint64_t> retries { 0 };
+    };
+
+    static std::size_t localShard() noexcept
+    {
+        static std::atomic<std::size_t> nextThread { 0 };
+        thread_local const auto index = nextThread.fetch_add (1, std::memory_order_relaxed) % numShards;
+        return index;
+    }
+
+    const std::size_t mask;
+    std::unique_ptr<Slot[]> slots;
+    const std::uint32_t sampleEvery;
+    std::atomic<std::uint64_t> nextTraceId { 1 };
+    std::array<SampleCounter, numShards> sampleCounters;
+    alignas (64) std::atomic<std::uint64_t> tail { 0 };
+    alignas (64) std::atomic<std::uint64_t> droppedRecords { 0 };
+    alignas (64) std::uint64_t head = 0;
+};
+
+template <RetryClock Clock>
+void BasicTraceObserver<Clock>::onBackoff (int attempt, std::chrono::milliseconds delay) const noexcept
+{
+    record (attempt, static_cast<std::int32_t> (std::min<long long> (delay.count(), std::numeric_limits<std::int32_t>::max())),
+            AttemptRecord::Outcome::retrying, RetryErrorReason::exhausted);
+}
+
+template <RetryClock Clock>
+void BasicTraceObserver<Clock>::onSuccess (int attempts) const noexcept
+{
+    record (attempts, 0, AttemptRecord::Outcome::succeeded, RetryErrorReason::exhausted);
+}
+
+template <RetryClock Clock>
+void BasicTraceObserver<Clock>::onGiveUp (const RetryError& error) const noexcept
+{
+    record (error.attempts, 0, AttemptRecord::Outcome::gaveUp, error.reason);
+}
+
+template <RetryClock Clock>
+void BasicTraceObserver<Clock>::record (std::int32_t attempt, std::int32_t delay, AttemptRecord::Outcome outcome, RetryErrorReason reason) const noexcept
+{
+    if (buffer == nullptr)
+    {
+        return;
+    }
+
+    auto now = std::chrono::duration_cast<std::chrono::nanoseconds> (clock.now().time_since_epoch()).count();
+    buffer->push ({ now, traceId, attempt, delay, outcome, reason });
+}
+
+} // namespace retryxx
@@ -0,0 +1,102 @@
+//
+//  retryxx_virtual_clock.h
+//  retryxx
+//
+//  MIT License
+//
+//  Copyright (c) 2025 Jacob Sologub
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+#pragma once
+
+#include "retryxx_retry.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace retryxx
+{
+
+/// A RetryClock whose time only moves when it is told to. Waiting out a backoff
+/// advances it by the backoff and returns at once, so a schedule that would take
+/// minutes of real time runs in microseconds, and deadlines and CircuitBreaker open
+/// periods are judged against the same virtual time. Copies share one time, so a
+/// test can keep a copy and hand another to the retry through its options.
+///
+/// Backoffs waited out on different threads all advance the one shared time, so a
+/// VirtualClock is best driven from a single thread.
+class VirtualClock
+{
+public:
+    /// Creates a clock reading start, the steady_clock epoch by default
+    explicit VirtualClock (std::chrono::steady_clock::time_point start = {})
+      : state (std::make_shared<State> (start.time_since_epoch().count()))
+    {
+    }
+
+    /// Returns the current virtual time
+    std::chrono::steady_clock::time_point now() const noexcept
+    {
+        return std::chrono::steady_clock::time_point (std::chrono::steady_clock::duration (state->ticks.load (std::memory_order_relaxed)));
+    }
+
+    /// Moves the virtual time forward, e.g. to stand in for a slow attempt
+    void advance (std::chrono::steady_clock::duration duration) const noexcept
+    {
+        state->ticks.fetch_add (duration.count(), std::memory_order_relaxed);
+    }
+
+    /// Waits out a backoff by advancing the time by duration, without blocking.
+    /// @returns    True if stop was requested, in which case the time is left alone
+    bool sleepFor (std::chrono::milliseconds duration, const stop_token& stopToken) const noexcept
+    {
+        if (stopToken.stop_requested())
+        {
+            return true;
+        }
+
+        advance (duration);
+        state->sleeps.fetch_add (1, std::memory_order_relaxed);
+        return false;
+    }
+
+    /// Returns the number of backoffs waited out on this clock
+    std::uint64_t getSleepCount() const noexcept
+    {
+        return state->sleeps.load (std::memory_order_relaxed);
+    }
+
+private:
+    struct State
+    {
+        explicit State (std::chrono::steady_clock::rep start) noexcept : ticks (start) {}
+
+        std::atomic<std::chrono::steady_clock::rep> ticks;
+        std::atomic<std::uint64_t> sleeps { 0 };
+    };
+
+    std::shared_ptr<State> state;
+};
+
+static_assert (RetryClock<VirtualClock>);
+
+} // namespace retryxx
@@ -0,0 +1,138 @@
+//
+//  retryxx_adaptive_test.cpp
+//  retryxx
+//
+//  MIT License
+//
+//  Copyright (c) 2025 Jacob Sologub
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+
+#include <retryxx/retryxx_adaptive.h>
+#include <retryxx/retryxx_virtual_clock.h>
+
+#include "retryxx_test.h"
+
+namespace
+{
+
+using namespace std::chrono_literals;
+
+} // namespace
+
+RETRYXX_TEST (AdaptiveBackoffTest, StartsAtTheMinimumDelay)
+{
+    retryxx::AdaptiveBackoff backoff (10ms, 1s);
+
+    CHECK (backoff.getBaseDelay (1) == 10ms);
+    CHECK (backoff.getErrorRate() == 0.0);
+    CHECK (backoff.getAverageLatency() == 0ns);
+}
+
+RETRYXX_TEST (AdaptiveBackoffTest, FailuresGrowTheDelayAndSuccessesShrinkIt)
+{
+    retryxx::AdaptiveBackoff backoff (10ms, 1s, 2.0, 10ms, 1.0);
+
+    backoff.recordOutcome (false, 1ms);
+    backoff.recordOutcome (false, 1ms);
+    backoff.recordOutcome (false, 1ms);
+
+    // With smoothing 1.0 the error rate is the last sample, so the base delay shows alone on attempt 1
+    CHECK (backoff.getErrorRate() == 1.0);
+    CHECK (backoff.getBaseDelay (1) == 80ms);
+    CHECK (backoff.getBaseDelay (2) == 160ms);
+
+    backoff.recordOutcome (true, 1ms);
+    CHECK (backoff.getErrorRate() == 0.0);
+    CHECK (backoff.getBaseDelay (1) == 70ms);
+    CHECK (backoff.getBaseDelay (2) == 70ms);
+
+    for (int i = 0; i < 20; ++i)
+    {
+        backoff.recordOutcome (true, 1ms);
+    }
+
+    CHECK (backoff.getBaseDelay (1) == 10ms);
+}
+
+RETRYXX_TEST (AdaptiveBackoffTest, DelayIsCappedAtTheMaximum)
+{
+    retryxx::AdaptiveBackoff backoff (10ms, 100ms);
+
+    for (int i = 0; i < 20; ++i)
+    {
+        backoff.recordOutcome (false, 1ms);
+    }
+
+    CHECK (backoff.getBaseDelay (10) == 100ms);
+
+    for (int attempt = 1; attempt < 10; ++attempt)
+    {
+        CHECK (backoff.getDelay (attempt) <= 100ms);
+    }
+}
+
+RETRYXX_TEST (AdaptiveBackoffTest, GrowsFromAZeroMinimum)
+{
+    retryxx::AdaptiveBackoff backoff (0ms, 1s, 2.0, 10ms, 1.0);
+
+    backoff.recordOutcome (false, 1ms);
+    CHECK (backoff.getBaseDelay (1) == 2ms);
+
+    backoff.recordOutcome (false, 1ms);
+    CHECK (backoff.getBaseDelay (1) == 4ms);
+}
+
+RETRYXX_TEST (AdaptiveBackoffTest, RisingLatencyStretchesTheDelay)
+{
+    retryxx::AdaptiveBackoff backoff (10ms, 1s, 2.0, 10ms, 0.5);
+
+    backoff.recordOutcome (true, 1ms);
+    auto healthy = backoff.getBaseDelay (1);
+
+    for (int i = 0; i < 5; ++i)
+    {
+        backoff.recordOutcome (true, 100ms);
+    }
+
+    CHECK (backoff.getAverageLatency() > 50ms);
+    CHECK (backoff.getBaseDelay (1) > healthy);
+}
+
+RETRYXX_TEST (AdaptiveBackoffTest, RetryFeedsEveryAttemptIntoTheSharedState)
+{
+    retryxx::VirtualClock clock;
+    retryxx::AdaptiveBackoff backoff (10ms, 1s, 2.0, 10ms, 1.0);
+    int calls = 0;
+
+    auto result = retryxx::retry ([&]() { clock.advance (5ms); return ++calls < 4 ? 503 : 200; },
+                                  [] (int statusCode) { return statusCode != 200; },
+                                  [] (const std::exception&) { return true; },
+                                  5, retryxx::AdaptiveBackoffPolicy { backoff }, {},
+                                  retryxx::BasicRetryOptions<retryxx::NoObserver, retryxx::VirtualClock> { .clock = clock });
+
+    REQUIRE (result.has_value());
+    CHECK (backoff.getErrorRate() == 0.0);
+    CHECK (backoff.getAverageLatency() == 5ms);
+    CHECK (backoff.getBaseDelay (1) == 70ms);
+}
+
+RETRYXX_TEST_MAIN
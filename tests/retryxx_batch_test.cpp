@@ -0,0 +1,210 @@
+//
+//  retryxx_batch_test.cpp
+//  retryxx
+//
+//  MIT License
+//
+//  Copyright (c) 2025 Jacob Sologub
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+
+#include <retryxx/retryxx_batch.h>
+#include <retryxx/retryxx_virtual_clock.h>
+
+#include "retryxx_test.h"
+
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+
+using namespace std::chrono_literals;
+
+using VirtualOptions = retryxx::BasicRetryOptions<retryxx::NoObserver, retryxx::VirtualClock>;
+
+auto isRetryable = [] (int statusCode) { return statusCode == 503; };
+auto alwaysRetry = [] (const std::exception&) { return true; };
+
+/// A bulk endpoint that fails each item a set number of times before accepting it, and
+/// records every batch it was sent
+struct FlakyBulkEndpoint
+{
+    std::vector<int> operator() (std::span<const int> batch)
+    {
+        calls.emplace_back (batch.begin(), batch.end());
+
+        std::vector<int> statuses;
+        for (auto item : batch)
+        {
+            if (item < 0)
+            {
+                statuses.push_back (400);
+            }
+            else
+            {
+                statuses.push_back (seen[item]++ < item ? 503 : 200);
+            }
+        }
+
+        return statuses;
+    }
+
+    std::map<int, int> seen;
+    std::vector<std::vector<int>> calls;
+};
+
+} // namespace
+
+RETRYXX_TEST (RetryBatchTest, ResubmitsOnlyTheFailedItems)
+{
+    retryxx::VirtualClock clock;
+    FlakyBulkEndpoint endpoint;
+    std::vector<int> items { 0, 1, 2, 0 };
+
+    auto result = retryxx::retry_batch (items, std::ref (endpoint), isRetryable, alwaysRetry,
+                                        5, retryxx::BackoffPolicy (10ms), {}, VirtualOptions { .clock = clock });
+
+    CHECK (static_cast<bool> (result));
+    CHECK (result.failedItems.empty());
+    CHECK (! result.error.has_value());
+    CHECK (result.statuses == std::vector<int> { 200, 200, 200, 200 });
+
+    REQUIRE (endpoint.calls.size() == 3);
+    CHECK (endpoint.calls[0] == items);
+    CHECK (endpoint.calls[1] == std::vector<int> { 1, 2 });
+    CHECK (endpoint.calls[2] == std::vector<int> { 2 });
+}
+
+RETRYXX_TEST (RetryBatchTest, ReportsItemsStillRetryableWhenExhausted)
+{
+    retryxx::VirtualClock clock;
+    FlakyBulkEndpoint endpoint;
+    std::vector<int> items { 0, 5, 1, 9 };
+
+    auto result = retryxx::retry_batch (items, std::ref (endpoint), isRetryable, alwaysRetry,
+                                        3, retryxx::BackoffPolicy (10ms), {}, VirtualOptions { .clock = clock });
+
+    CHECK (! result);
+    CHECK (result.failedItems == std::vector<std::size_t> { 1, 3 });
+    REQUIRE (result.error.has_value());
+    CHECK (result.error->reason == retryxx::RetryErrorReason::exhausted);
+    CHECK (result.error->attempts == 3);
+    CHECK (result.statuses == std::vector<int> { 200, 503, 200, 503 });
+}
+
+RETRYXX_TEST (RetryBatchTest, DeclinedStatusesAreSettledButKeepTheirStatus)
+{
+    retryxx::VirtualClock clock;
+    FlakyBulkEndpoint endpoint;
+    std::vector<int> items { -1, 1 };
+
+    auto result = retryxx::retry_batch (items, std::ref (endpoint), isRetryable, alwaysRetry,
+                                        5, retryxx::BackoffPolicy (10ms), {}, VirtualOptions { .clock = clock });
+
+    CHECK (result.failedItems.empty());
+    CHECK (result.statuses == std::vector<int> { 400, 200 });
+    REQUIRE (endpoint.calls.size() == 2);
+    CHECK (endpoint.calls[1] == std::vector<int> { 1 });
+}
+
+RETRYXX_TEST (RetryBatchTest, MissingStatusesCountAsFailures)
+{
+    retryxx::VirtualClock clock;
+    int calls = 0;
+    std::vector<int> items { 1, 2, 3 };
+
+    auto result = retryxx::retry_batch (items,
+                                        [&] (std::span<const int> batch)
+                                        {
+                                            ++calls;
+                                            return std::vector<int> (std::min<std::size_t> (batch.size(), 2), 200);
+                                        },
+                                        isRetryable, alwaysRetry, 5, retryxx::BackoffPolicy (10ms), {},
+                                        VirtualOptions { .clock = clock });
+
+    CHECK (static_cast<bool> (result));
+    CHECK (calls == 2);
+}
+
+RETRYXX_TEST (RetryBatchTest, ExceptionsRetryThePendingItems)
+{
+    retryxx::VirtualClock clock;
+    int calls = 0;
+    std::vector<int> items { 1, 2 };
+
+    auto result = retryxx::retry_batch (items,
+                                        [&] (std::span<const int> batch)
+                                        {
+                                            if (++calls == 1)
+                                            {
+                                                throw std::runtime_error ("connection reset");
+                                            }
+
+                                            return std::vector<int> (batch.size(), 200);
+                                        },
+                                        isRetryable, alwaysRetry, 5, retryxx::BackoffPolicy (10ms), {},
+                                        VirtualOptions { .clock = clock });
+
+    CHECK (static_cast<bool> (result));
+    CHECK (calls == 2);
+}
+
+RETRYXX_TEST (RetryBatchTest, WaitsForTheLongestRetryAfter)
+{
+    retryxx::VirtualClock clock;
+    int calls = 0;
+    std::vector<int> items { 1, 2 };
+
+    auto result = retryxx::retry_batch (items,
+                                        [&] (std::span<const int> batch)
+                                        {
+                                            return ++calls == 1 ? std::vector<int> { 1, 3 } : std::vector<int> (batch.size(), 0);
+                                        },
+                                        [] (int retryAfterSeconds)
+                                        {
+                                            return retryAfterSeconds > 0 ? retryxx::RetryDecision::retryAfter (std::chrono::seconds (retryAfterSeconds))
+                                                                         : retryxx::RetryDecision::stop();
+                                        },
+                                        alwaysRetry, 5, retryxx::BackoffPolicy (10ms, 2.0, 1min), {},
+                                        VirtualOptions { .clock = clock });
+
+    CHECK (static_cast<bool> (result));
+    CHECK (calls == 2);
+    CHECK (clock.now().time_since_epoch() == 3s);
+}
+
+RETRYXX_TEST (RetryBatchTest, EmptyInputMakesNoCall)
+{
+    int calls = 0;
+    std::vector<int> items;
+
+    auto result = retryxx::retry_batch (items, [&] (std::span<const int>) { ++calls; return std::vector<int>(); },
+                                        isRetryable, alwaysRetry);
+
+    CHECK (static_cast<bool> (result));
+    CHECK (result.statuses.empty());
+    CHECK (calls == 0);
+}
+
+RETRYXX_TEST_MAIN
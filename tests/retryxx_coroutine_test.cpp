@@ -0,0 +1,157 @@
+//
+//  retryxx_coroutine_test.cpp
+//  retryxx
+//
+//  MIT License
+//
+//  Copyright (c) 2025 Jacob Sologub
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+
+#include <retryxx/retryxx_coroutine.h>
+
+#include "retryxx_test.h"
+
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace
+{
+
+using namespace std::chrono_literals;
+
+using Result = retryxx::expected<int, retryxx::RetryError>;
+
+retryxx::Task<int> failAsync()
+{
+    co_return 503;
+}
+
+retryxx::Task<int> throwAsync()
+{
+    throw std::runtime_error ("connection reset");
+    co_return 200;
+}
+
+auto isFailure = [] (int code) { return code != 200; };
+auto alwaysRetry = [] (const std::exception&) { return true; };
+
+/// Runs a task on a RunLoop on the calling thread and returns its result
+template <typename T>
+T runToCompletion (retryxx::RunLoop& loop, retryxx::Task<T> task)
+{
+    std::optional<T> result;
+    retryxx::spawn (std::move (task), [&] (T r) { result = std::move (r); loop.stop(); });
+    loop.run();
+    return std::move (*result);
+}
+
+/// Awaits a co_retry that is not meant to catch anything and reports what escaped it
+retryxx::Task<std::string> escapedException (retryxx::RunLoop& loop)
+{
+    try
+    {
+        co_await retryxx::co_retry (loop, throwAsync, isFailure, retryxx::detail::PropagateExceptions{});
+    }
+    catch (const std::runtime_error& e)
+    {
+        co_return e.what();
+    }
+
+    co_return "nothing";
+}
+
+} // namespace
+
+RETRYXX_TEST (CoroutineTest, RetriesUntilSuccess)
+{
+    retryxx::RunLoop loop;
+    int calls = 0;
+
+    auto result = runToCompletion (loop, retryxx::co_retry (loop,
+                                                            [&]() -> retryxx::Task<int> { co_return ++calls < 3 ? 503 : 200; },
+                                                            isFailure, alwaysRetry, 5, retryxx::BackoffPolicy (1ms, 1.0, 1ms)));
+
+    REQUIRE (result.has_value());
+    CHECK (*result == 200);
+    CHECK (calls == 3);
+}
+
+RETRYXX_TEST (CoroutineTest, RetriesUntilExhausted)
+{
+    retryxx::RunLoop loop;
+    auto result = runToCompletion (loop, retryxx::co_retry (loop, failAsync, isFailure, alwaysRetry,
+                                                            3, retryxx::BackoffPolicy (1ms, 1.0, 1ms)));
+
+    REQUIRE (! result.has_value());
+    CHECK (result.error().reason == retryxx::RetryErrorReason::exhausted);
+    CHECK (result.error().attempts == 3);
+}
+
+RETRYXX_TEST (CoroutineTest, JudgesExceptionsLikeRetry)
+{
+    retryxx::RunLoop loop;
+
+    auto retried = runToCompletion (loop, retryxx::co_retry (loop, throwAsync, isFailure, alwaysRetry,
+                                                             2, retryxx::BackoffPolicy (1ms, 1.0, 1ms)));
+    REQUIRE (! retried.has_value());
+    CHECK (retried.error().reason == retryxx::RetryErrorReason::exhausted);
+    CHECK (retried.error().exception != nullptr);
+
+    auto declined = runToCompletion (loop, retryxx::co_retry (loop, throwAsync, isFailure,
+                                                              [] (const std::exception&) { return false; }));
+    REQUIRE (! declined.has_value());
+    CHECK (declined.error().reason == retryxx::RetryErrorReason::nonRetryableException);
+    CHECK (declined.error().attempts == 1);
+}
+
+RETRYXX_TEST (CoroutineTest, UncaughtExceptionTypesPropagate)
+{
+    retryxx::RunLoop loop;
+    CHECK (runToCompletion (loop, escapedException (loop)) == "connection reset");
+}
+
+RETRYXX_TEST (CoroutineTest, CancellationEndsTheBackoff)
+{
+    retryxx::RunLoop loop;
+    retryxx::stop_source source;
+    std::thread canceller ([&]
+    {
+        std::this_thread::sleep_for (50ms);
+        source.request_stop();
+    });
+
+    auto started = std::chrono::steady_clock::now();
+    auto result = runToCompletion (loop, retryxx::co_retry (loop, failAsync, isFailure, alwaysRetry,
+                                                            5, retryxx::JitteredBackoffPolicy<retryxx::NoJitter> (10s, 1.0, 10s), source.get_token()));
+    auto elapsed = std::chrono::steady_clock::now() - started;
+
+    canceller.join();
+
+    REQUIRE (! result.has_value());
+    CHECK (result.error().reason == retryxx::RetryErrorReason::cancelled);
+    CHECK (result.error().attempts == 1);
+    CHECK (elapsed < 5s);
+}
+
+RETRYXX_TEST_MAIN
@@ -0,0 +1,180 @@
+//
+//  retryxx_executor_test.cpp
+//  retryxx
+//
+//  MIT License
+//
+//  Copyright (c) 2025 Jacob Sologub
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+
+#include <retryxx/retryxx_executor.h>
+
+#include "retryxx_test.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+using namespace std::chrono_literals;
+
+auto isFailure = [] (int statusCode) { return statusCode != 200; };
+auto alwaysRetry = [] (const std::exception&) { return true; };
+
+} // namespace
+
+RETRYXX_TEST (RetryExecutorTest, RetriesOnThePool)
+{
+    retryxx::RetryExecutor executor (2);
+    std::atomic<int> calls { 0 };
+
+    auto result = executor.submit ([&]() { return ++calls < 3 ? 503 : 200; },
+                                   isFailure, alwaysRetry, 5, retryxx::BackoffPolicy (1ms, 1.0, 1ms)).get();
+
+    REQUIRE (result.has_value());
+    CHECK (*result == 200);
+    CHECK (calls == 3);
+    CHECK (executor.pending() == 0);
+}
+
+RETRYXX_TEST (RetryExecutorTest, ReportsExhaustionAndExceptions)
+{
+    retryxx::RetryExecutor executor (2);
+
+    auto exhausted = executor.submit ([]() { return 503; },
+                                      isFailure, alwaysRetry, 3, retryxx::BackoffPolicy (1ms, 1.0, 1ms)).get();
+    REQUIRE (! exhausted.has_value());
+    CHECK (exhausted.error().reason == retryxx::RetryErrorReason::exhausted);
+    CHECK (exhausted.error().attempts == 3);
+
+    auto nonRetryable = executor.submit ([]() -> int { throw std::logic_error ("bug"); },
+                                         isFailure, [] (const std::exception&) { return false; }).get();
+    REQUIRE (! nonRetryable.has_value());
+    CHECK (nonRetryable.error().reason == retryxx::RetryErrorReason::nonRetryableException);
+    CHECK (nonRetryable.error().attempts == 1);
+}
+
+RETRYXX_TEST (RetryExecutorTest, CancellationEndsTheBackoff)
+{
+    retryxx::RetryExecutor executor (1);
+    retryxx::stop_source source;
+
+    auto started = std::chrono::steady_clock::now();
+    auto future = executor.submit ([]() { return 503; },
+                                   isFailure, alwaysRetry, 5, retryxx::JitteredBackoffPolicy<retryxx::NoJitter> (10s, 1.0, 10s), source.get_token());
+
+    while (executor.pending() == 0)
+    {
+        std::this_thread::yield();
+    }
+
+    source.request_stop();
+    auto result = future.get();
+
+    REQUIRE (! result.has_value());
+    CHECK (result.error().reason == retryxx::RetryErrorReason::cancelled);
+    CHECK (result.error().attempts == 1);
+    CHECK (std::chrono::steady_clock::now() - started < 5s);
+}
+
+RETRYXX_TEST (RetryExecutorTest, ShutdownCancelsPendingRetries)
+{
+    std::future<retryxx::expected<int, retryxx::RetryError>> future;
+
+    {
+        retryxx::RetryExecutor executor (1);
+        future = executor.submit ([]() { return 503; },
+                                  isFailure, alwaysRetry, 5, retryxx::JitteredBackoffPolicy<retryxx::NoJitter> (10s, 1.0, 10s));
+
+        while (executor.pending() == 0)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    auto result = future.get();
+    REQUIRE (! result.has_value());
+    CHECK (result.error().reason == retryxx::RetryErrorReason::cancelled);
+}
+
+RETRYXX_TEST (RetryExecutorTest, BlockingAttemptsRunOnSeveralWorkers)
+{
+    retryxx::RetryExecutor executor (4);
+    std::atomic<int> running { 0 };
+
+    // Each attempt blocks until all four are running at once, which needs four workers
+    auto attempt = [&]()
+    {
+        ++running;
+
+        while (running < 4)
+        {
+            std::this_thread::yield();
+        }
+
+        return 200;
+    };
+
+    std::vector<std::future<retryxx::expected<int, retryxx::RetryError>>> futures;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        futures.push_back (executor.submit (attempt, isFailure, alwaysRetry));
+    }
+
+    for (auto& future : futures)
+    {
+        CHECK (future.get().has_value());
+    }
+}
+
+RETRYXX_TEST (RetryExecutorTest, ManyConcurrentRetries)
+{
+    retryxx::RetryExecutor executor (4);
+    std::vector<std::future<retryxx::expected<int, retryxx::RetryError>>> futures;
+    std::atomic<int> calls { 0 };
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        futures.push_back (executor.submit ([&, first = true]() mutable
+                                            {
+                                                ++calls;
+                                                return std::exchange (first, false) ? 503 : 200;
+                                            },
+                                            isFailure, alwaysRetry, 3, retryxx::BackoffPolicy (5ms, 1.0, 5ms)));
+    }
+
+    int succeeded = 0;
+    for (auto& future : futures)
+    {
+        succeeded += future.get().has_value() ? 1 : 0;
+    }
+
+    CHECK (succeeded == 1000);
+    CHECK (calls == 2000);
+}
+
+RETRYXX_TEST_MAIN
@@ -0,0 +1,228 @@
+//
+//  retryxx_hedge_test.cpp
+//  retryxx
+//
+//  MIT License
+//
+//  Copyright (c) 2025 Jacob Sologub
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+
+#include <retryxx/retryxx_hedge.h>
+
+#include "retryxx_test.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+
+using namespace std::chrono_literals;
+
+auto isFailure = [] (int statusCode) { return statusCode != 200; };
+auto alwaysRetry = [] (const std::exception&) { return true; };
+
+/// Blocks until stop is requested or a long timeout passes
+int waitForStop (const retryxx::stop_token& stopToken)
+{
+    auto giveUpAt = std::chrono::steady_clock::now() + 5s;
+    while (! stopToken.stop_requested() && std::chrono::steady_clock::now() < giveUpAt)
+    {
+        std::this_thread::sleep_for (1ms);
+    }
+
+    return 499;
+}
+
+} // namespace
+
+RETRYXX_TEST (HedgeTest, FastAttemptLaunchesNoHedge)
+{
+    retryxx::RetryScheduler scheduler (2);
+    std::atomic<int> calls { 0 };
+
+    auto result = retryxx::hedge (scheduler, [&]() { ++calls; return 200; }, isFailure, alwaysRetry,
+                                  { .delay = 200ms, .maxHedges = 1 });
+
+    REQUIRE (result.has_value());
+    CHECK (*result == 200);
+
+    std::this_thread::sleep_for (300ms);
+    CHECK (calls == 1);
+    CHECK (scheduler.pending() == 0);
+}
+
+RETRYXX_TEST (HedgeTest, HedgeOvertakesASlowAttempt)
+{
+    retryxx::RetryScheduler scheduler (2);
+    std::atomic<int> calls { 0 };
+    std::atomic<bool> loserStopped { false };
+
+    auto started = std::chrono::steady_clock::now();
+    auto result = retryxx::hedge (scheduler,
+                                  [&] (retryxx::stop_token stopToken)
+                                  {
+                                      if (++calls == 1)
+                                      {
+                                          auto status = waitForStop (stopToken);
+                                          loserStopped = stopToken.stop_requested();
+                                          return status;
+                                      }
+
+                                      return 200;
+                                  },
+                                  isFailure, alwaysRetry, { .delay = 20ms, .maxHedges = 1 });
+
+    REQUIRE (result.has_value());
+    CHECK (*result == 200);
+    CHECK (std::chrono::steady_clock::now() - started < 2s);
+
+    while (calls == 2 && ! loserStopped && std::chrono::steady_clock::now() - started < 5s)
+    {
+        std::this_thread::yield();
+    }
+
+    CHECK (loserStopped);
+}
+
+RETRYXX_TEST (HedgeTest, FailedAttemptLaunchesTheNextHedgeStraightAway)
+{
+    retryxx::RetryScheduler scheduler (3);
+    std::atomic<int> calls { 0 };
+
+    auto started = std::chrono::steady_clock::now();
+    auto result = retryxx::hedge (scheduler, [&]() { return ++calls < 3 ? 503 : 200; }, isFailure, alwaysRetry,
+                                  { .delay = 10s, .maxHedges = 2 });
+
+    REQUIRE (result.has_value());
+    CHECK (calls == 3);
+    CHECK (std::chrono::steady_clock::now() - started < 5s);
+}
+
+RETRYXX_TEST (HedgeTest, ExhaustedWhenEveryAttemptFails)
+{
+    retryxx::RetryScheduler scheduler (3);
+
+    auto result = retryxx::hedge (scheduler, []() -> int { throw std::runtime_error ("unavailable"); },
+                                  isFailure, alwaysRetry, { .delay = 1ms, .maxHedges = 2 });
+
+    REQUIRE (! result.has_value());
+    CHECK (result.error().reason == retryxx::RetryErrorReason::exhausted);
+    CHECK (result.error().attempts == 3);
+    CHECK (result.error().exception != nullptr);
+}
+
+RETRYXX_TEST (HedgeTest, NonRetryableExceptionEndsTheHedge)
+{
+    retryxx::RetryScheduler scheduler (2);
+
+    auto result = retryxx::hedge (scheduler, []() -> int { throw std::logic_error ("bug"); },
+                                  isFailure, [] (const std::exception&) { return false; }, { .delay = 10s, .maxHedges = 1 });
+
+    REQUIRE (! result.has_value());
+    CHECK (result.error().reason == retryxx::RetryErrorReason::nonRetryableException);
+    CHECK (result.error().attempts == 1);
+}
+
+RETRYXX_TEST (HedgeTest, TooFewThreadsIsAnError)
+{
+    retryxx::RetryScheduler scheduler (1);
+    int calls = 0;
+
+    auto result = retryxx::hedge (scheduler, [&]() { ++calls; return 200; }, isFailure, alwaysRetry, { .maxHedges = 1 });
+
+    REQUIRE (! result.has_value());
+    CHECK (result.error().reason == retryxx::RetryErrorReason::invalidArgument);
+    CHECK (result.error().attempts == 0);
+    CHECK (calls == 0);
+}
+
+RETRYXX_TEST (HedgeTest, CancellationStopsWaiting)
+{
+    retryxx::RetryScheduler scheduler (2);
+    retryxx::stop_source source;
+
+    std::thread canceller ([&]
+    {
+        std::this_thread::sleep_for (50ms);
+        source.request_stop();
+    });
+
+    auto result = retryxx::hedge (scheduler, [] (retryxx::stop_token stopToken) { return waitForStop (stopToken); },
+                                  isFailure, alwaysRetry, { .delay = 10s, .maxHedges = 1 }, source.get_token());
+    canceller.join();
+
+    REQUIRE (! result.has_value());
+    CHECK (result.error().reason == retryxx::RetryErrorReason::cancelled);
+}
+
+RETRYXX_TEST (LatencyTrackerTest, PercentileIsWithinABucketOfTheSamples)
+{
+    retryxx::LatencyTracker tracker;
+    CHECK (tracker.percentile (0.5) == 0ms);
+
+    for (int i = 1; i <= 100; ++i)
+    {
+        tracker.record (std::chrono::milliseconds (i));
+    }
+
+    CHECK (tracker.count() == 100u);
+
+    auto p50 = tracker.percentile (0.5);
+    CHECK (p50 >= 50ms);
+    CHECK (p50 <= 63ms);
+
+    auto p99 = tracker.percentile (0.99);
+    CHECK (p99 >= 99ms);
+    CHECK (p99 <= 124ms);
+}
+
+RETRYXX_TEST (HedgePolicyTest, DelayComesFromTheTrackerOnceItHasEnoughSamples)
+{
+    retryxx::LatencyTracker tracker;
+    retryxx::HedgePolicy policy { .delay = 50ms, .latencyTracker = &tracker, .minimumSamples = 10 };
+
+    for (int i = 0; i < 9; ++i)
+    {
+        tracker.record (200ms);
+    }
+
+    CHECK (policy.getDelay() == 50ms);
+
+    tracker.record (200ms);
+    CHECK (policy.getDelay() >= 200ms);
+}
+
+RETRYXX_TEST (HedgePolicyTest, DelayIsNeverBelowTheMinimum)
+{
+    retryxx::LatencyTracker tracker;
+    retryxx::HedgePolicy policy { .latencyTracker = &tracker, .minimumSamples = 1, .minimumDelay = 5ms };
+
+    tracker.record (std::chrono::microseconds (10));
+    CHECK (policy.getDelay() == 5ms);
+
+    retryxx::HedgePolicy fixed { .delay = 0ms };
+    CHECK (fixed.getDelay() == 1ms);
+}
+
+RETRYXX_TEST_MAIN
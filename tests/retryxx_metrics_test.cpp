@@ -0,0 +1,180 @@
+//
+//  retryxx_metrics_test.cpp
+//  retryxx
+//
+//  MIT License
+//
+//  Copyright (c) 2025 Jacob Sologub
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+
+#include <retryxx/retryxx_metrics.h>
+#include <retryxx/retryxx_virtual_clock.h>
+
+#include "retryxx_test.h"
+
+#include <sstream>
+#include <vector>
+
+namespace
+{
+
+using namespace std::chrono_literals;
+
+auto alwaysRetry = [] (const std::exception&) { return true; };
+auto isFailure = [] (int statusCode) { return statusCode != 200; };
+
+retryxx::JitteredBackoffPolicy<retryxx::NoJitter> exactBackoff()
+{
+    return { 100ms, 2.0, 10s };
+}
+
+/// Observer with non-const callbacks that records what it is told in its own members,
+/// and reports them through a pointer once the retry is over
+struct RecordingObserver
+{
+    void onAttempt (int attempt)                                { events.push_back (attempt); }
+    void onBackoff (int, std::chrono::milliseconds delay)       { events.push_back (static_cast<int> (-delay.count())); }
+    void onSuccess (int attempts)                               { *finished = attempts; *seen = events; }
+    void onGiveUp (const retryxx::RetryError& error)            { *finished = -error.attempts; *seen = events; }
+
+    std::vector<int> events;
+    int* finished = nullptr;
+    std::vector<int>* seen = nullptr;
+};
+
+template <typename Observer>
+using ObservedOptions = retryxx::BasicRetryOptions<Observer, retryxx::VirtualClock>;
+
+} // namespace
+
+RETRYXX_TEST (ObserverTest, ByValueObserverSeesEveryStepOfItsRetry)
+{
+    retryxx::VirtualClock clock;
+    int finished = 0;
+    std::vector<int> seen;
+    int calls = 0;
+
+    auto result = retryxx::retry ([&]() { return ++calls < 3 ? 503 : 200; },
+                                  isFailure, alwaysRetry, 5, exactBackoff(), {},
+                                  ObservedOptions<RecordingObserver> { .observer = { {}, &finished, &seen }, .clock = clock });
+
+    REQUIRE (result.has_value());
+    CHECK (finished == 3);
+    CHECK ((seen == std::vector<int> { 1, -100, 2, -200, 3 }));
+}
+
+RETRYXX_TEST (ObserverTest, ByValueObserverIsCopiedForEachRetry)
+{
+    retryxx::VirtualClock clock;
+    int finished = 0;
+    std::vector<int> seen;
+    ObservedOptions<RecordingObserver> options { .observer = { {}, &finished, &seen }, .clock = clock };
+
+    for (int i = 0; i < 2; ++i)
+    {
+        auto result = retryxx::retry ([]() { return 503; }, isFailure, alwaysRetry, 2, exactBackoff(), {}, options);
+        CHECK (! result.has_value());
+    }
+
+    CHECK (finished == -2);
+    CHECK ((seen == std::vector<int> { 1, -100, 2 }));
+    CHECK (options.observer.events.empty());
+}
+
+RETRYXX_TEST (ObserverTest, GiveUpBeforeTheFirstAttemptIsObserved)
+{
+    retryxx::VirtualClock clock (std::chrono::steady_clock::time_point (1h));
+    int finished = 1;
+    std::vector<int> seen { 42 };
+    ObservedOptions<RecordingObserver> options { .observer = { {}, &finished, &seen }, .clock = clock };
+    options.deadline = clock.now();
+
+    auto result = retryxx::retry ([]() { return 200; }, isFailure, alwaysRetry, 5, exactBackoff(), {}, options);
+
+    REQUIRE (! result.has_value());
+    CHECK (finished == 0);
+    CHECK (seen.empty());
+}
+
+RETRYXX_TEST (RetryMetricsTest, CountsAttemptsBackoffsAndOutcomes)
+{
+    retryxx::VirtualClock clock;
+    retryxx::RetryMetrics metrics;
+    ObservedOptions<retryxx::RetryMetrics*> options { .observer = &metrics, .clock = clock };
+    int calls = 0;
+
+    CHECK (retryxx::retry ([&]() { return ++calls < 3 ? 503 : 200; }, isFailure, alwaysRetry, 5, exactBackoff(), {}, options).has_value());
+    CHECK (! retryxx::retry ([]() { return 503; }, isFailure, alwaysRetry, 2, exactBackoff(), {}, options).has_value());
+
+    auto totals = metrics.snapshot();
+    CHECK (totals.calls == 2);
+    CHECK (totals.attempts == 5);
+    CHECK (totals.retries == 3);
+    CHECK (totals.successes == 1);
+    CHECK (totals.backoffs == 3);
+    CHECK (totals.backoffMilliseconds == 400);
+    CHECK (totals.giveUps[static_cast<std::size_t> (retryxx::RetryErrorReason::exhausted)] == 1);
+
+    // 100ms falls in the bucket up to 128ms, 200ms in the one up to 256ms
+    CHECK (totals.backoffBuckets[7] == 2);
+    CHECK (totals.backoffBuckets[8] == 1);
+}
+
+RETRYXX_TEST (RetryMetricsTest, CountsCallsRefusedBeforeTheirFirstAttempt)
+{
+    retryxx::VirtualClock clock;
+    retryxx::RetryMetrics metrics;
+    retryxx::CircuitBreaker breaker (0.5, 1);
+    breaker.recordFailure (clock);
+
+    ObservedOptions<retryxx::RetryMetrics*> options { .circuitBreaker = &breaker, .observer = &metrics, .clock = clock };
+    auto result = retryxx::retry ([]() { return 200; }, isFailure, alwaysRetry, 5, exactBackoff(), {}, options);
+
+    REQUIRE (! result.has_value());
+    CHECK (result.error().reason == retryxx::RetryErrorReason::circuitOpen);
+
+    auto totals = metrics.snapshot();
+    CHECK (totals.calls == 1);
+    CHECK (totals.attempts == 0);
+    CHECK (totals.giveUps[static_cast<std::size_t> (retryxx::RetryErrorReason::circuitOpen)] == 1);
+}
+
+RETRYXX_TEST (RetryMetricsTest, WritesPrometheusText)
+{
+    retryxx::VirtualClock clock;
+    retryxx::RetryMetrics metrics;
+    ObservedOptions<retryxx::RetryMetrics*> options { .observer = &metrics, .clock = clock };
+
+    CHECK (! retryxx::retry ([]() { return 503; }, isFailure, alwaysRetry, 2, exactBackoff(), {}, options).has_value());
+
+    std::ostringstream text;
+    metrics.writePrometheus (text, "test");
+    auto output = text.str();
+
+    CHECK (output.find ("test_calls_total 1\n") != std::string::npos);
+    CHECK (output.find ("test_attempts_total 2\n") != std::string::npos);
+    CHECK (output.find ("test_give_ups_total{reason=\"exhausted\"} 1\n") != std::string::npos);
+    CHECK (output.find ("test_backoff_seconds_bucket{le=\"+Inf\"} 1\n") != std::string::npos);
+    CHECK (output.find ("test_backoff_seconds_sum 0.1\n") != std::string::npos);
+}
+
+RETRYXX_TEST_MAIN
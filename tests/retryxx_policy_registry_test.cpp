@@ -0,0 +1,173 @@
+//
+//  retryxx_policy_registry_test.cpp
+//  retryxx
+//
+//  MIT License
+//
+//  Copyright (c) 2025 Jacob Sologub
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+
+#include <retryxx/retryxx_policy_registry.h>
+#include <retryxx/retryxx_virtual_clock.h>
+
+#include "retryxx_test.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+using namespace std::chrono_literals;
+
+using Registry = retryxx::RetryPolicyRegistry<std::string, int>;
+
+auto isFailure = [] (int statusCode) { return statusCode != 200; };
+auto alwaysRetry = [] (const std::exception&) { return true; };
+
+} // namespace
+
+RETRYXX_TEST (RetryPolicyRegistryTest, FindsRegisteredSettingsAndFallsBackToTheDefault)
+{
+    Registry registry ({ { "payments", 3 }, { "search", 7 }, { "payments", 4 } }, -1);
+
+    CHECK (registry.size() == 2);
+    CHECK (registry.find ("payments") == 4);
+    CHECK (registry.find ("search") == 7);
+    CHECK (! registry.find ("billing").has_value());
+    CHECK (registry.get ("billing") == -1);
+}
+
+RETRYXX_TEST (RetryPolicyRegistryTest, ChangesAreSeenByTheNextLookup)
+{
+    Registry registry ({ { "payments", 3 } });
+    CHECK (registry.get ("payments") == 3);
+
+    registry.set ("payments", 5);
+    registry.set ("search", 2);
+    CHECK (registry.get ("payments") == 5);
+    CHECK (registry.get ("search") == 2);
+
+    CHECK (registry.erase ("payments"));
+    CHECK (! registry.erase ("payments"));
+    CHECK (! registry.find ("payments").has_value());
+
+    registry.reload ({ { "billing", 9 } });
+    CHECK (registry.size() == 1);
+    CHECK (registry.get ("billing") == 9);
+    CHECK (! registry.find ("search").has_value());
+}
+
+RETRYXX_TEST (RetryPolicyRegistryTest, ManyRegistriesKeepTheirOwnSettings)
+{
+    std::vector<std::unique_ptr<Registry>> registries;
+
+    for (int i = 0; i < 32; ++i)
+    {
+        registries.push_back (std::make_unique<Registry> (std::vector<std::pair<std::string, int>> { { "endpoint", i } }));
+    }
+
+    for (int round = 0; round < 3; ++round)
+    {
+        for (int i = 0; i < 32; ++i)
+        {
+            CHECK (registries[static_cast<std::size_t> (i)]->get ("endpoint") == i);
+        }
+    }
+
+    // Destroying some of them leaves the others' cached tables intact
+    for (std::size_t i = 0; i < registries.size(); i += 2)
+    {
+        registries[i].reset();
+    }
+
+    for (std::size_t i = 1; i < registries.size(); i += 2)
+    {
+        CHECK (registries[i]->get ("endpoint") == static_cast<int> (i));
+    }
+
+    auto replacement = std::make_unique<Registry> (std::vector<std::pair<std::string, int>> { { "endpoint", 100 } });
+    CHECK (replacement->get ("endpoint") == 100);
+    CHECK (registries[1]->get ("endpoint") == 1);
+}
+
+RETRYXX_TEST (RetryPolicyRegistryTest, ReadersNeverGoBackToAnOlderTable)
+{
+    Registry registry ({ { "endpoint", 0 } });
+    std::atomic<bool> done { false };
+    std::atomic<bool> wentBackwards { false };
+    std::vector<std::thread> readers;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        readers.emplace_back ([&]
+                              {
+                                  int last = 0;
+
+                                  while (! done.load())
+                                  {
+                                      auto value = registry.get ("endpoint");
+                                      wentBackwards = wentBackwards || value < last;
+                                      last = value;
+                                  }
+                              });
+    }
+
+    for (int version = 1; version <= 200; ++version)
+    {
+        registry.reload ({ { "endpoint", version } });
+    }
+
+    done = true;
+
+    for (auto& reader : readers)
+    {
+        reader.join();
+    }
+
+    CHECK (! wentBackwards);
+    CHECK (registry.get ("endpoint") == 200);
+}
+
+RETRYXX_TEST (RetryPolicyRegistryTest, RetryUsesTheEndpointsSettings)
+{
+    retryxx::RetryPolicyRegistry<std::string, retryxx::EndpointPolicy<retryxx::JitteredBackoffPolicy<retryxx::NoJitter>>> registry (
+        { { "payments", { { 10ms, 2.0, 1s }, 2 } } },
+        { { 10ms, 2.0, 1s }, 4 });
+
+    retryxx::VirtualClock clock;
+    retryxx::BasicRetryOptions<retryxx::NoObserver, retryxx::VirtualClock> options { .clock = clock };
+
+    auto payments = registry.retry ("payments", []() { return 503; }, isFailure, alwaysRetry, {}, options);
+    REQUIRE (! payments.has_value());
+    CHECK (payments.error().attempts == 2);
+
+    auto other = registry.retry ("search", []() { return 503; }, isFailure, alwaysRetry, {}, options);
+    REQUIRE (! other.has_value());
+    CHECK (other.error().attempts == 4);
+    CHECK (clock.now() - std::chrono::steady_clock::time_point{} == 10ms + 10ms + 20ms + 40ms);
+}
+
+RETRYXX_TEST_MAIN
@@ -0,0 +1,234 @@
+//
+//  retryxx_retry_task_test.cpp
+//  retryxx
+//
+//  MIT License
+//
+//  Copyright (c) 2025 Jacob Sologub
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+
+#include <retryxx/retryxx_retry_task.h>
+
+#include "retryxx_test.h"
+
+#include <array>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace
+{
+
+using namespace std::chrono_literals;
+
+using Result = retryxx::expected<int, retryxx::RetryError>;
+
+/// Fails until its last attempt and remembers where it was stored when it ran, which
+/// tells whether the task held it inline or on the heap
+template <std::size_t Padding>
+struct FlakyCall
+{
+    int operator()()
+    {
+        *lastAddress = this;
+        return ++*calls < succeedOn ? 503 : 200;
+    }
+
+    std::shared_ptr<int> calls = std::make_shared<int> (0);
+    std::shared_ptr<const void*> lastAddress = std::make_shared<const void*> (nullptr);
+    int succeedOn = 3;
+    std::array<char, Padding> padding {};
+};
+
+auto isFailure = [] (int statusCode) { return statusCode != 200; };
+auto alwaysRetry = [] (const std::exception&) { return true; };
+
+template <typename Task>
+bool storedIn (const Task& task, const void* address)
+{
+    auto* begin = reinterpret_cast<const char*> (&task);
+    auto* at = static_cast<const char*> (address);
+    return at >= begin && at < begin + sizeof (Task);
+}
+
+/// Drives a task to completion, moving it to a new object before every attempt
+template <typename Task>
+void runMovingEachTime (Task task, const void* const& lastAddress, bool expectInline)
+{
+    auto backoff = retryxx::BackoffPolicy (1ms, 1.0, 1ms);
+
+    while (true)
+    {
+        auto moved = new Task (std::move (task));
+        CHECK (! task);
+        REQUIRE (*moved);
+
+        bool finished = moved->run();
+        CHECK (storedIn (*moved, lastAddress) == expectInline);
+
+        if (finished)
+        {
+            CHECK (! *moved);
+            delete moved;
+            return;
+        }
+
+        CHECK (moved->nextDelay() <= backoff.maxDelay);
+        task = std::move (*moved);
+        delete moved;
+    }
+}
+
+} // namespace
+
+RETRYXX_TEST (RetryTaskTest, SmallRetryIsStoredInline)
+{
+    FlakyCall<8> call;
+    std::optional<Result> result;
+
+    auto task = retryxx::makeRetryTask (call, isFailure, alwaysRetry,
+                                        [&] (Result r) { result = std::move (r); },
+                                        5, retryxx::BackoffPolicy (1ms, 1.0, 1ms));
+
+    runMovingEachTime (std::move (task), *call.lastAddress, true);
+
+    REQUIRE (result.has_value());
+    REQUIRE (result->has_value());
+    CHECK (**result == 200);
+    CHECK (*call.calls == 3);
+}
+
+RETRYXX_TEST (RetryTaskTest, LargeRetryMovesToTheHeap)
+{
+    FlakyCall<512> call;
+    std::optional<Result> result;
+
+    auto task = retryxx::makeRetryTask (call, isFailure, alwaysRetry,
+                                        [&] (Result r) { result = std::move (r); },
+                                        5, retryxx::BackoffPolicy (1ms, 1.0, 1ms));
+
+    runMovingEachTime (std::move (task), *call.lastAddress, false);
+
+    REQUIRE (result.has_value());
+    REQUIRE (result->has_value());
+    CHECK (*call.calls == 3);
+}
+
+RETRYXX_TEST (RetryTaskTest, SmallerTaskSizeMovesToTheHeap)
+{
+    FlakyCall<8> call;
+    std::optional<Result> result;
+
+    auto task = retryxx::makeRetryTask<64> (call, isFailure, alwaysRetry,
+                                            [&] (Result r) { result = std::move (r); },
+                                            5, retryxx::BackoffPolicy (1ms, 1.0, 1ms));
+
+    static_assert (sizeof (task) == 64);
+    runMovingEachTime (std::move (task), *call.lastAddress, false);
+
+    REQUIRE (result.has_value());
+    CHECK (*call.calls == 3);
+}
+
+RETRYXX_TEST (RetryTaskTest, SurvivesVectorGrowth)
+{
+    std::vector<retryxx::RetryTask> pending;
+    std::vector<FlakyCall<8>> calls (3);
+    int completed = 0;
+
+    for (auto& call : calls)
+    {
+        pending.push_back (retryxx::makeRetryTask (call, isFailure, alwaysRetry,
+                                                   [&] (Result r) { completed += r.has_value(); },
+                                                   5, retryxx::BackoffPolicy (1ms, 1.0, 1ms)));
+    }
+
+    for (int round = 0; round < 3; ++round)
+    {
+        for (auto& task : pending)
+        {
+            task.run();
+        }
+    }
+
+    CHECK (completed == 3);
+    for (auto& task : pending)
+    {
+        CHECK (! task);
+    }
+}
+
+RETRYXX_TEST (RetryTaskTest, ExhaustsAfterMaxAttempts)
+{
+    FlakyCall<8> call;
+    call.succeedOn = 100;
+    std::optional<Result> result;
+
+    auto task = retryxx::makeRetryTask (call, isFailure, alwaysRetry, [&] (Result r) { result = std::move (r); },
+                                        2, retryxx::BackoffPolicy (1ms, 1.0, 1ms));
+
+    CHECK (! task.run());
+    CHECK (task.run());
+
+    REQUIRE (result.has_value());
+    REQUIRE (! result->has_value());
+    CHECK (result->error().reason == retryxx::RetryErrorReason::exhausted);
+    CHECK (result->error().attempts == 2);
+}
+
+RETRYXX_TEST (RetryTaskTest, CancelCompletesTheRetry)
+{
+    FlakyCall<8> call;
+    std::optional<Result> result;
+
+    auto task = retryxx::makeRetryTask (call, isFailure, alwaysRetry, [&] (Result r) { result = std::move (r); });
+
+    CHECK (! task.run());
+    task.cancel();
+
+    CHECK (! task);
+    REQUIRE (result.has_value());
+    REQUIRE (! result->has_value());
+    CHECK (result->error().reason == retryxx::RetryErrorReason::cancelled);
+    CHECK (result->error().attempts == 1);
+}
+
+RETRYXX_TEST (RetryTaskTest, StopTokenCancelsOnNextRun)
+{
+    FlakyCall<8> call;
+    retryxx::stop_source source;
+    std::optional<Result> result;
+
+    auto task = retryxx::makeRetryTask (call, isFailure, alwaysRetry, [&] (Result r) { result = std::move (r); },
+                                        5, retryxx::BackoffPolicy (1ms, 1.0, 1ms), source.get_token());
+
+    CHECK (! task.run());
+    source.request_stop();
+    CHECK (task.run());
+
+    CHECK (*call.calls == 1);
+    REQUIRE (result.has_value());
+    REQUIRE (! result->has_value());
+    CHECK (result->error().reason == retryxx::RetryErrorReason::cancelled);
+}
+
+RETRYXX_TEST_MAIN
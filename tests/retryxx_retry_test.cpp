@@ -0,0 +1,839 @@
+//
+//  retryxx_retry_test.cpp
+//  retryxx
+//
+//  MIT License
+//
+//  Copyright (c) 2025 Jacob Sologub
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+
+#include <retryxx/retryxx_retry.h>
+#include <retryxx/retryxx_virtual_clock.h>
+
+#include "retryxx_test.h"
+
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace
+{
+
+using namespace std::chrono_literals;
+
+using VirtualOptions = retryxx::BasicRetryOptions<retryxx::NoObserver, retryxx::VirtualClock>;
+
+/// A policy whose delays are exact, so the virtual time a schedule takes can be checked
+retryxx::JitteredBackoffPolicy<retryxx::NoJitter> exactBackoff (std::chrono::milliseconds initial = 100ms)
+{
+    return { initial, 2.0, 10s };
+}
+
+auto alwaysRetry = [] (const std::exception&) { return true; };
+auto neverRetry = [] (const std::exception&) { return false; };
+auto isFailure = [] (int statusCode) { return statusCode != 200; };
+
+/// Requests stop on source after delay, from another thread
+struct DelayedStop
+{
+    DelayedStop (retryxx::stop_source& source, std::chrono::milliseconds delay)
+      : thread ([&source, delay]
+                {
+                    std::this_thread::sleep_for (delay);
+                    source.request_stop();
+                })
+    {
+    }
+
+    ~DelayedStop()    { thread.join(); }
+
+    std::thread thread;
+};
+
+/// Result that counts how often it was copied, and cannot be default-constructed
+struct CopyCounter
+{
+    explicit CopyCounter (int attemptId) : id (attemptId) {}
+    CopyCounter (const CopyCounter& other) : id (other.id), copies (other.copies + 1) {}
+    CopyCounter (CopyCounter&&) noexcept = default;
+    CopyCounter& operator= (const CopyCounter&) = delete;
+    CopyCounter& operator= (CopyCounter&&) = delete;
+
+    int id;
+    int copies = 0;
+};
+
+} // namespace
+
+RETRYXX_TEST (RetryTest, SucceedsOnFirstAttempt)
+{
+    int calls = 0;
+    auto result = retryxx::retry ([&]() { ++calls; return 200; }, isFailure, alwaysRetry);
+
+    REQUIRE (result.has_value());
+    CHECK (*result == 200);
+    CHECK (calls == 1);
+}
+
+RETRYXX_TEST (RetryTest, SucceedsAfterRetries)
+{
+    retryxx::VirtualClock clock;
+    int calls = 0;
+
+    auto result = retryxx::retry ([&]() { return ++calls < 3 ? 503 : 200; },
+                                  isFailure, alwaysRetry, 5, exactBackoff(), {},
+                                  VirtualOptions { .clock = clock });
+
+    REQUIRE (result.has_value());
+    CHECK (calls == 3);
+    CHECK (clock.getSleepCount() == 2u);
+    CHECK (clock.now().time_since_epoch() == 300ms);
+}
+
+
+RETRYXX_TEST (VirtualClockTest, CopiesShareOneTime)
+{
+    retryxx::VirtualClock clock (std::chrono::steady_clock::time_point (1h));
+    auto copy = clock;
+
+    CHECK (clock.now().time_since_epoch() == 1h);
+
+    copy.advance (5s);
+    CHECK (clock.now().time_since_epoch() == 1h + 5s);
+    CHECK (copy.now() == clock.now());
+}
+
+RETRYXX_TEST (VirtualClockTest, SleepsAdvanceTimeUnlessStopped)
+{
+    retryxx::VirtualClock clock;
+    retryxx::stop_source source;
+
+    CHECK (! clock.sleepFor (250ms, source.get_token()));
+    CHECK (clock.now().time_since_epoch() == 250ms);
+    CHECK (clock.getSleepCount() == 1u);
+
+    source.request_stop();
+    CHECK (clock.sleepFor (250ms, source.get_token()));
+    CHECK (clock.now().time_since_epoch() == 250ms);
+    CHECK (clock.getSleepCount() == 1u);
+}
+
+RETRYXX_TEST (VirtualClockTest, LongSchedulesRunWithoutRealSleeps)
+{
+    retryxx::VirtualClock clock;
+    auto started = std::chrono::steady_clock::now();
+
+    auto result = retryxx::retry ([]() { return 503; }, isFailure, alwaysRetry, 10,
+                                  exactBackoff (1s), {}, VirtualOptions { .clock = clock });
+
+    REQUIRE (! result.has_value());
+    CHECK (clock.getSleepCount() == 9u);
+
+    // 1 + 2 + 4 + 8 seconds, then five more waits at the 10 second cap
+    CHECK (clock.now().time_since_epoch() == 65s);
+    CHECK (std::chrono::steady_clock::now() - started < 1s);
+}
+
+RETRYXX_TEST (BackoffPolicyTest, BaseDelayGrowsGeometricallyUpToTheCap)
+{
+    retryxx::BackoffPolicy policy (100ms, 2.0, 1s);
+
+    CHECK (policy.getBaseDelay (1) == 100ms);
+    CHECK (policy.getBaseDelay (2) == 200ms);
+    CHECK (policy.getBaseDelay (4) == 800ms);
+    CHECK (policy.getBaseDelay (5) == 1s);
+    CHECK (policy.getBaseDelay (1000000) == 1s);
+}
+
+RETRYXX_TEST (BackoffPolicyTest, FractionalMultipliersAreHonoured)
+{
+    retryxx::BackoffPolicy policy (100ms, 1.5, 10s);
+
+    CHECK (policy.getBaseDelay (2) == 150ms);
+    CHECK (policy.getBaseDelay (3) == 225ms);
+    CHECK (policy.getBaseDelay (4) == 337ms);
+}
+
+RETRYXX_TEST (BackoffPolicyTest, FullJitterStaysWithinTheBaseDelay)
+{
+    retryxx::BackoffPolicy policy (100ms, 2.0, 1s);
+
+    for (int attempt = 1; attempt < 64; ++attempt)
+    {
+        auto delay = policy.getDelay (attempt);
+        CHECK (delay >= 0ms);
+        CHECK (delay <= policy.getBaseDelay (attempt));
+    }
+}
+
+RETRYXX_TEST (BackoffPolicyTest, NoJitterWaitsTheBaseDelay)
+{
+    retryxx::JitteredBackoffPolicy<retryxx::NoJitter> policy (100ms, 2.0, 1s);
+
+    for (int attempt = 1; attempt < 8; ++attempt)
+    {
+        CHECK (policy.getDelay (attempt) == policy.getBaseDelay (attempt));
+    }
+}
+
+RETRYXX_TEST (BackoffPolicyTest, EqualJitterWaitsAtLeastHalfTheBaseDelay)
+{
+    retryxx::JitteredBackoffPolicy<retryxx::EqualJitter> policy (100ms, 2.0, 1s);
+
+    for (int attempt = 1; attempt < 64; ++attempt)
+    {
+        auto delay = policy.getDelay (attempt);
+        CHECK (delay >= policy.getBaseDelay (attempt) / 2);
+        CHECK (delay <= policy.getBaseDelay (attempt));
+    }
+}
+
+RETRYXX_TEST (BackoffPolicyTest, DecorrelatedJitterStaysWithinThreeTimesThePreviousDelay)
+{
+    retryxx::JitteredBackoffPolicy<retryxx::DecorrelatedJitter> policy (100ms, 2.0, 1s);
+    auto previous = 100ms;
+
+    for (int attempt = 1; attempt < 64; ++attempt)
+    {
+        auto delay = policy.getDelay (attempt);
+        CHECK (delay >= 100ms);
+        CHECK (delay <= std::min<std::chrono::milliseconds> (previous * 3, 1s));
+        previous = delay;
+    }
+
+    // The first attempt starts over from initialDelay, so a reused policy does not carry a long delay forward
+    CHECK (policy.getDelay (1) <= 300ms);
+}
+
+RETRYXX_TEST (InterruptibleSleepTest, SleepsTheWholeDurationWithoutStop)
+{
+    retryxx::stop_source source;
+
+    auto started = std::chrono::steady_clock::now();
+    CHECK (! retryxx::detail::interruptibleSleep (20ms, source.get_token()));
+    CHECK (std::chrono::steady_clock::now() - started >= 20ms);
+
+    CHECK (! retryxx::detail::interruptibleSleep (1ms, retryxx::stop_token{}));
+}
+
+RETRYXX_TEST (InterruptibleSleepTest, WakesAsSoonAsStopIsRequested)
+{
+    retryxx::stop_source source;
+    DelayedStop stop (source, 20ms);
+
+    auto started = std::chrono::steady_clock::now();
+    CHECK (retryxx::detail::interruptibleSleep (10s, source.get_token()));
+    CHECK (std::chrono::steady_clock::now() - started < 5s);
+
+    CHECK (retryxx::detail::interruptibleSleep (10s, source.get_token()));
+}
+
+RETRYXX_TEST (RetryErrorTest, CancelledDuringBackoff)
+{
+    retryxx::stop_source source;
+    DelayedStop stop (source, 50ms);
+
+    auto started = std::chrono::steady_clock::now();
+    auto result = retryxx::retry ([]() { return 503; }, isFailure, alwaysRetry, 5,
+                                  exactBackoff (10s), source.get_token());
+
+    REQUIRE (! result.has_value());
+    CHECK (result.error().reason == retryxx::RetryErrorReason::cancelled);
+    CHECK (result.error().attempts == 1);
+    CHECK (std::chrono::steady_clock::now() - started < 5s);
+}
+
+RETRYXX_TEST (RetryErrorTest, ExhaustedAfterRejectedResults)
+{
+    retryxx::VirtualClock clock;
+    int calls = 0;
+
+    auto result = retryxx::retry ([&]() { ++calls; return 503; },
+                                  isFailure, alwaysRetry, 3, exactBackoff(), {},
+                                  VirtualOptions { .clock = clock });
+
+    REQUIRE (! result.has_value());
+    CHECK (result.error().reason == retryxx::RetryErrorReason::exhausted);
+    CHECK (result.error().attempts == 3);
+    CHECK (result.error().exception == nullptr);
+    CHECK (result.error().message() == "Retry failed after 3 attempts.");
+    CHECK (calls == 3);
+}
+
+RETRYXX_TEST (RetryErrorTest, ExhaustedKeepsLastException)
+{
+    retryxx::VirtualClock clock;
+
+    auto result = retryxx::retry ([]() -> int { throw std::runtime_error ("unavailable"); },
+                                  isFailure, alwaysRetry, 2, exactBackoff(), {},
+                                  VirtualOptions { .clock = clock });
+
+    REQUIRE (! result.has_value());
+    CHECK (result.error().reason == retryxx::RetryErrorReason::exhausted);
+    CHECK (result.error().attempts == 2);
+    CHECK (result.error().exception != nullptr);
+}
+
+RETRYXX_TEST (RetryErrorTest, NonRetryableException)
+{
+    int calls = 0;
+    auto result = retryxx::retry ([&]() -> int { ++calls; throw std::invalid_argument ("bad request"); },
+                                  isFailure, neverRetry);
+
+    REQUIRE (! result.has_value());
+    CHECK (result.error().reason == retryxx::RetryErrorReason::nonRetryableException);
+    CHECK (result.error().attempts == 1);
+    CHECK (result.error().message() == "Retry failed with exception: bad request");
+    CHECK (calls == 1);
+}
+
+RETRYXX_TEST (RetryErrorTest, CancelledBeforeTheFirstBackoff)
+{
+    retryxx::VirtualClock clock;
+    retryxx::stop_source source;
+    int calls = 0;
+
+    auto result = retryxx::retry ([&]() { ++calls; source.request_stop(); return 503; },
+                                  isFailure, alwaysRetry, 5, exactBackoff(), source.get_token(),
+                                  VirtualOptions { .clock = clock });
+
+    REQUIRE (! result.has_value());
+    CHECK (result.error().reason == retryxx::RetryErrorReason::cancelled);
+    CHECK (result.error().attempts == 1);
+    CHECK (result.error().message() == "Retry operation was cancelled after 1 attempts.");
+    CHECK (calls == 1);
+    CHECK (clock.getSleepCount() == 0u);
+}
+
+RETRYXX_TEST (RetryErrorTest, EveryReasonHasAMessage)
+{
+    using Reason = retryxx::RetryErrorReason;
+
+    CHECK (retryxx::RetryError { Reason::budgetExhausted, 2, nullptr }.message() == "Retry budget exhausted after 2 attempts.");
+    CHECK (retryxx::RetryError { Reason::circuitOpen, 0, nullptr }.message() == "Circuit breaker open after 0 attempts.");
+    CHECK (retryxx::RetryError { Reason::deadlineExceeded, 4, nullptr }.message() == "Retry deadline exceeded after 4 attempts.");
+    CHECK (retryxx::RetryError { Reason::invalidArgument, 0, nullptr }.message() == "Retry could not start with the arguments given.");
+    CHECK (retryxx::RetryError { Reason::nonRetryableException, 1, nullptr }.message() == "Retry failed with exception: unknown exception");
+
+    std::ostringstream stream;
+    stream << retryxx::RetryError { Reason::exhausted, 5, nullptr };
+    CHECK (stream.str() == "Retry failed after 5 attempts.");
+}
+
+RETRYXX_TEST (RetryErrorTest, BudgetExhausted)
+{
+    retryxx::VirtualClock clock;
+    retryxx::RetryBudget budget (0.0, 1);
+    auto available = static_cast<int> (budget.availableRetries());
+    int calls = 0;
+
+    auto result = retryxx::retry ([&]() { ++calls; return 503; },
+                                  isFailure, alwaysRetry, 1000, exactBackoff (1ms), {},
+                                  VirtualOptions { .budget = &budget, .clock = clock });
+
+    REQUIRE (! result.has_value());
+    CHECK (result.error().reason == retryxx::RetryErrorReason::budgetExhausted);
+    CHECK (result.error().attempts == available + 1);
+    CHECK (calls == available + 1);
+    CHECK (budget.availableRetries() < 1.0);
+}
+
+RETRYXX_TEST (RetryBudgetTest, RequestsRefillTheBudget)
+{
+    retryxx::RetryBudget budget (0.5, 1);
+
+    while (budget.tryConsumeRetry())
+    {
+    }
+
+    CHECK (! budget.tryConsumeRetry());
+
+    budget.recordRequest();
+    budget.recordRequest();
+    CHECK (budget.tryConsumeRetry());
+    CHECK (! budget.tryConsumeRetry());
+}
+
+RETRYXX_TEST (RetryErrorTest, CircuitOpen)
+{
+    retryxx::VirtualClock clock;
+    retryxx::CircuitBreaker breaker (0.5, 1);
+    breaker.recordFailure (clock);
+    REQUIRE (breaker.getState() == retryxx::CircuitBreaker::State::open);
+
+    int calls = 0;
+    auto result = retryxx::retry ([&]() { ++calls; return 200; },
+                                  isFailure, alwaysRetry, 5, exactBackoff(), {},
+                                  VirtualOptions { .circuitBreaker = &breaker, .clock = clock });
+
+    REQUIRE (! result.has_value());
+    CHECK (result.error().reason == retryxx::RetryErrorReason::circuitOpen);
+    CHECK (result.error().attempts == 0);
+    CHECK (calls == 0);
+}
+
+RETRYXX_TEST (RetryErrorTest, CircuitOpensMidRetry)
+{
+    retryxx::VirtualClock clock;
+    retryxx::CircuitBreaker breaker (0.5, 2);
+    int calls = 0;
+
+    auto result = retryxx::retry ([&]() { ++calls; return 503; },
+                                  isFailure, alwaysRetry, 5, exactBackoff(), {},
+                                  VirtualOptions { .circuitBreaker = &breaker, .clock = clock });
+
+    REQUIRE (! result.has_value());
+    CHECK (result.error().reason == retryxx::RetryErrorReason::circuitOpen);
+    CHECK (result.error().attempts == 2);
+    CHECK (calls == 2);
+}
+
+RETRYXX_TEST (RetryErrorTest, DeadlineExceeded)
+{
+    retryxx::VirtualClock clock;
+    auto deadline = clock.now() + 1s;
+    int calls = 0;
+
+    auto result = retryxx::retry ([&]() { ++calls; clock.advance (100ms); return 503; },
+                                  isFailure, alwaysRetry, deadline, exactBackoff(), {},
+                                  VirtualOptions { .clock = clock });
+
+    REQUIRE (! result.has_value());
+    CHECK (result.error().reason == retryxx::RetryErrorReason::deadlineExceeded);
+    CHECK (result.error().attempts == calls);
+    CHECK (clock.now() <= deadline);
+    CHECK (calls > 1);
+}
+
+RETRYXX_TEST (RetryErrorTest, DeadlineAlreadyPassed)
+{
+    retryxx::VirtualClock clock (std::chrono::steady_clock::time_point (1h));
+    int calls = 0;
+
+    auto result = retryxx::retry ([&]() { ++calls; return 200; },
+                                  isFailure, alwaysRetry, clock.now() - 1ms, exactBackoff(), {},
+                                  VirtualOptions { .clock = clock });
+
+    REQUIRE (! result.has_value());
+    CHECK (result.error().reason == retryxx::RetryErrorReason::deadlineExceeded);
+    CHECK (result.error().attempts == 0);
+    CHECK (calls == 0);
+}
+
+
+RETRYXX_TEST (RetryErrorTest, DeadlineShortensTheLastBackoff)
+{
+    retryxx::VirtualClock clock;
+    VirtualOptions options { .clock = clock };
+    options.deadline = clock.now() + 250ms;
+    int calls = 0;
+
+    auto result = retryxx::retry ([&]() { clock.advance (10ms); return ++calls < 3 ? 503 : 200; },
+                                  isFailure, alwaysRetry, 5, exactBackoff(), {}, options);
+
+    // The second backoff of 200ms would leave no room for a 10ms attempt, so it is cut to 120ms
+    REQUIRE (result.has_value());
+    CHECK (calls == 3);
+    CHECK (clock.now() == options.deadline);
+}
+
+RETRYXX_TEST (RetryDecisionTest, BoolsConvertToRetryAndStop)
+{
+    static_assert (retryxx::RetryDecision (true).getKind() == retryxx::RetryDecision::Kind::retry);
+    static_assert (retryxx::RetryDecision (false).getKind() == retryxx::RetryDecision::Kind::stop);
+    static_assert (retryxx::RetryDecision::retryAfter (5ms).shouldRetry());
+    static_assert (retryxx::RetryDecision::retryAfter (-5ms).getDelay() == 0ms);
+    CHECK (! retryxx::RetryDecision::stop().shouldRetry());
+}
+
+RETRYXX_TEST (RetryDecisionTest, RetryAfterReplacesTheBackoffDelay)
+{
+    retryxx::VirtualClock clock;
+    auto start = clock.now();
+    int calls = 0;
+
+    auto result = retryxx::retry ([&]() { return ++calls < 3 ? 503 : 200; },
+                                  [] (int statusCode) -> retryxx::RetryDecision
+                                  {
+                                      if (statusCode == 200)
+                                      {
+                                          return retryxx::RetryDecision::stop();
+                                      }
+
+                                      return retryxx::RetryDecision::retryAfter (3s);
+                                  },
+                                  alwaysRetry, 5, exactBackoff(), {}, VirtualOptions { .clock = clock });
+
+    REQUIRE (result.has_value());
+    CHECK (calls == 3);
+    CHECK (clock.now() - start == 6s);
+}
+
+RETRYXX_TEST (RetryDecisionTest, ExceptionPredicateCanHintADelay)
+{
+    retryxx::VirtualClock clock;
+    auto start = clock.now();
+    int calls = 0;
+
+    auto result = retryxx::retry ([&]()
+                                  {
+                                      if (++calls < 2)
+                                      {
+                                          throw std::runtime_error ("busy");
+                                      }
+
+                                      return 200;
+                                  },
+                                  isFailure,
+                                  [] (const std::exception&) { return retryxx::RetryDecision::retryAfter (750ms); },
+                                  5, exactBackoff(), {}, VirtualOptions { .clock = clock });
+
+    REQUIRE (result.has_value());
+    CHECK (clock.getSleepCount() == 1);
+    CHECK (clock.now() - start == 750ms);
+}
+
+RETRYXX_TEST (RetryDecisionTest, HintPastTheDeadlineIsNotWaited)
+{
+    retryxx::VirtualClock clock;
+    VirtualOptions options { .clock = clock };
+    options.deadline = clock.now() + 1s;
+    int calls = 0;
+
+    auto result = retryxx::retry ([&]() { ++calls; return 503; },
+                                  [] (int) { return retryxx::RetryDecision::retryAfter (5s); },
+                                  alwaysRetry, 5, exactBackoff(), {}, options);
+
+    REQUIRE (! result.has_value());
+    CHECK (result.error().reason == retryxx::RetryErrorReason::deadlineExceeded);
+    CHECK (calls == 1);
+    CHECK (clock.getSleepCount() == 0);
+}
+
+RETRYXX_TEST (CircuitBreakerTest, OpensHalfOpensAndCloses)
+{
+    using State = retryxx::CircuitBreaker::State;
+
+    retryxx::VirtualClock clock;
+    retryxx::CircuitBreaker breaker (0.5, 4, 10s, 30s);
+
+    CHECK (breaker.getState() == State::closed);
+
+    breaker.recordSuccess (clock);
+    breaker.recordFailure (clock);
+    breaker.recordFailure (clock);
+    CHECK (breaker.getState() == State::closed); // below minimumRequests
+
+    breaker.recordFailure (clock);
+    CHECK (breaker.getState() == State::open);
+    CHECK (! breaker.allowRequest (clock));
+
+    clock.advance (29s);
+    CHECK (! breaker.allowRequest (clock));
+    CHECK (breaker.getState() == State::open);
+
+    clock.advance (1s);
+    CHECK (breaker.allowRequest (clock));
+    CHECK (breaker.getState() == State::halfOpen);
+    CHECK (! breaker.allowRequest (clock)); // only one probe at a time
+
+    breaker.recordSuccess (clock);
+    CHECK (breaker.getState() == State::closed);
+    CHECK (breaker.allowRequest (clock));
+}
+
+RETRYXX_TEST (CircuitBreakerTest, FailedProbeReopens)
+{
+    using State = retryxx::CircuitBreaker::State;
+
+    retryxx::VirtualClock clock;
+    retryxx::CircuitBreaker breaker (0.5, 1, 10s, 30s);
+
+    breaker.recordFailure (clock);
+    clock.advance (30s);
+    REQUIRE (breaker.allowRequest (clock));
+
+    breaker.recordFailure (clock);
+    CHECK (breaker.getState() == State::open);
+    CHECK (! breaker.allowRequest (clock));
+
+    clock.advance (30s);
+    CHECK (breaker.allowRequest (clock));
+}
+
+RETRYXX_TEST (CircuitBreakerTest, OldFailuresLeaveTheWindow)
+{
+    using State = retryxx::CircuitBreaker::State;
+
+    retryxx::VirtualClock clock (std::chrono::steady_clock::time_point (1h));
+    retryxx::CircuitBreaker breaker (0.5, 2, 10s, 30s);
+
+    breaker.recordFailure (clock);
+    clock.advance (20s);
+    breaker.recordFailure (clock);
+
+    CHECK (breaker.getState() == State::closed);
+}
+
+RETRYXX_TEST (RetryExpectedTest, RetriesErrorValuesUntilSuccess)
+{
+    retryxx::VirtualClock clock;
+    int calls = 0;
+
+    auto result = retryxx::retry_expected ([&]() -> retryxx::expected<int, std::string>
+                                           {
+                                               if (++calls < 3)
+                                               {
+                                                   return retryxx::unexpected<std::string> ("busy");
+                                               }
+
+                                               return 42;
+                                           },
+                                           [] (const std::string& error) { return error == "busy"; },
+                                           5, exactBackoff(), {}, VirtualOptions { .clock = clock });
+
+    REQUIRE (result.has_value());
+    REQUIRE (result->has_value());
+    CHECK (**result == 42);
+    CHECK (calls == 3);
+}
+
+RETRYXX_TEST (RetryExpectedTest, ReturnsAnErrorItDeclinedToRetry)
+{
+    retryxx::VirtualClock clock;
+    int calls = 0;
+
+    auto result = retryxx::retry_expected ([&]() -> retryxx::expected<int, std::string>
+                                           {
+                                               return retryxx::unexpected<std::string> (++calls < 2 ? "busy" : "not found");
+                                           },
+                                           [] (const std::string& error) { return error == "busy"; },
+                                           5, exactBackoff(), {}, VirtualOptions { .clock = clock });
+
+    REQUIRE (result.has_value());
+    REQUIRE (! result->has_value());
+    CHECK (result->error() == "not found");
+    CHECK (calls == 2);
+}
+
+RETRYXX_TEST (RetryExpectedTest, ExhaustedAfterRetryableErrors)
+{
+    retryxx::VirtualClock clock;
+    int calls = 0;
+
+    auto result = retryxx::retry_expected ([&]() -> retryxx::expected<int, std::string>
+                                           {
+                                               ++calls;
+                                               return retryxx::unexpected<std::string> ("busy");
+                                           },
+                                           [] (const std::string&) { return true; },
+                                           3, exactBackoff(), {}, VirtualOptions { .clock = clock });
+
+    REQUIRE (! result.has_value());
+    CHECK (result.error().reason == retryxx::RetryErrorReason::exhausted);
+    CHECK (result.error().attempts == 3);
+    CHECK (calls == 3);
+}
+
+RETRYXX_TEST (RetryExpectedTest, ExceptionsPropagate)
+{
+    retryxx::VirtualClock clock;
+    int calls = 0;
+    bool propagated = false;
+
+    try
+    {
+        (void) retryxx::retry_expected ([&]() -> retryxx::expected<int, std::string>
+                                        {
+                                            ++calls;
+                                            throw std::runtime_error ("boom");
+                                        },
+                                        [] (const std::string&) { return true; },
+                                        3, exactBackoff(), {}, VirtualOptions { .clock = clock });
+    }
+    catch (const std::runtime_error&)
+    {
+        propagated = true;
+    }
+
+    CHECK (propagated);
+    CHECK (calls == 1);
+}
+
+RETRYXX_TEST (RetryResultTest, MoveOnlyResultsAreRetried)
+{
+    retryxx::VirtualClock clock;
+    int calls = 0;
+
+    auto result = retryxx::retry ([&]() { return std::make_unique<int> (++calls); },
+                                  [] (const std::unique_ptr<int>& value) { return *value < 3; },
+                                  alwaysRetry, 5, exactBackoff(), {}, VirtualOptions { .clock = clock });
+
+    REQUIRE (result.has_value());
+    CHECK (**result == 3);
+}
+
+RETRYXX_TEST (RetryResultTest, AcceptedResultIsMovedNotCopied)
+{
+    retryxx::VirtualClock clock;
+    int calls = 0;
+
+    auto result = retryxx::retry ([&]() { return CopyCounter (++calls); },
+                                  [] (const CopyCounter& value) { return value.id < 3; },
+                                  alwaysRetry, 5, exactBackoff(), {}, VirtualOptions { .clock = clock });
+
+    REQUIRE (result.has_value());
+    CHECK (result->id == 3);
+    CHECK (result->copies == 0);
+}
+
+RETRYXX_TEST (RetryResultTest, RvalueCallableIsInvokedAsAnLvalue)
+{
+    retryxx::VirtualClock clock;
+
+    // Invoking it as an rvalue would move its payload out on the first attempt
+    struct Call
+    {
+        std::string operator()() &      { return payload; }
+        std::string operator()() &&     { return std::move (payload); }
+
+        std::string payload = "response";
+    };
+
+    int calls = 0;
+    auto result = retryxx::retry (Call{},
+                                  [&] (const std::string& value) { return ++calls < 3 || value.empty(); },
+                                  alwaysRetry, 5, exactBackoff(), {}, VirtualOptions { .clock = clock });
+
+    REQUIRE (result.has_value());
+    CHECK (*result == "response");
+    CHECK (calls == 3);
+}
+
+RETRYXX_TEST (AttemptTimeoutTest, FiresTheAttemptsStopToken)
+{
+    int calls = 0;
+    int timedOut = 0;
+
+    auto started = std::chrono::steady_clock::now();
+    auto result = retryxx::retry ([&] (retryxx::stop_token stopToken)
+                                  {
+                                      ++calls;
+
+                                      while (! stopToken.stop_requested())
+                                      {
+                                          std::this_thread::sleep_for (1ms);
+                                      }
+
+                                      ++timedOut;
+                                      return 504;
+                                  },
+                                  isFailure, alwaysRetry, 3, exactBackoff (1ms), {},
+                                  retryxx::RetryOptions { .attemptTimeout = 20ms });
+    auto elapsed = std::chrono::steady_clock::now() - started;
+
+    REQUIRE (! result.has_value());
+    CHECK (result.error().reason == retryxx::RetryErrorReason::exhausted);
+    CHECK (calls == 3);
+    CHECK (timedOut == 3);
+    CHECK (elapsed >= 60ms);
+    CHECK (elapsed < 5s);
+}
+
+RETRYXX_TEST (AttemptTimeoutTest, FastAttemptIsNotStopped)
+{
+    bool stopped = true;
+
+    auto result = retryxx::retry ([&] (retryxx::stop_token stopToken) { stopped = stopToken.stop_requested(); return 200; },
+                                  isFailure, alwaysRetry, 3, exactBackoff(), {},
+                                  retryxx::RetryOptions { .attemptTimeout = 10s });
+
+    REQUIRE (result.has_value());
+    CHECK (! stopped);
+}
+
+RETRYXX_TEST (AttemptTimeoutTest, CallerCancellationStillReachesTheAttempt)
+{
+    retryxx::stop_source source;
+    DelayedStop stop (source, 50ms);
+
+    auto result = retryxx::retry ([] (retryxx::stop_token stopToken)
+                                  {
+                                      while (! stopToken.stop_requested())
+                                      {
+                                          std::this_thread::sleep_for (1ms);
+                                      }
+
+                                      return 499;
+                                  },
+                                  isFailure, alwaysRetry, 3, exactBackoff(), source.get_token(),
+                                  retryxx::RetryOptions { .attemptTimeout = 10s });
+
+    REQUIRE (! result.has_value());
+    CHECK (result.error().reason == retryxx::RetryErrorReason::cancelled);
+    CHECK (result.error().attempts == 1);
+}
+
+RETRYXX_TEST (RetryCancellationTest, StopReachesARunningAttempt)
+{
+    retryxx::stop_source source;
+    DelayedStop stop (source, 50ms);
+    int calls = 0;
+
+    auto result = retryxx::retry ([&] (retryxx::stop_token stopToken)
+                                  {
+                                      ++calls;
+
+                                      while (! stopToken.stop_requested())
+                                      {
+                                          std::this_thread::sleep_for (1ms);
+                                      }
+
+                                      return 499;
+                                  },
+                                  isFailure, alwaysRetry, 3, exactBackoff(), source.get_token());
+
+    REQUIRE (! result.has_value());
+    CHECK (result.error().reason == retryxx::RetryErrorReason::cancelled);
+    CHECK (result.error().attempts == 1);
+    CHECK (calls == 1);
+}
+
+RETRYXX_TEST (RetryCancellationTest, AcceptedResultOfAStoppedAttemptIsKept)
+{
+    retryxx::stop_source source;
+
+    auto result = retryxx::retry ([&] (retryxx::stop_token stopToken)
+                                  {
+                                      source.request_stop();
+                                      return stopToken.stop_requested() ? 200 : 503;
+                                  },
+                                  isFailure, alwaysRetry, 3, exactBackoff(), source.get_token());
+
+    REQUIRE (result.has_value());
+    CHECK (*result == 200);
+}
+
+RETRYXX_TEST_MAIN
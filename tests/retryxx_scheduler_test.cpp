@@ -0,0 +1,268 @@
+//
+//  retryxx_scheduler_test.cpp
+//  retryxx
+//
+//  MIT License
+//
+//  Copyright (c) 2025 Jacob Sologub
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+
+#include <retryxx/retryxx_scheduler.h>
+
+#include "retryxx_test.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+using namespace std::chrono_literals;
+
+/// A node that is never run, the wheel tests only look at when it comes out
+struct RecordingNode : retryxx::detail::TimerNode
+{
+    void run() override        {}
+    void abandon() override    {}
+};
+
+std::vector<RecordingNode*> advanceTo (retryxx::detail::TimerWheel& wheel, std::uint64_t tick)
+{
+    retryxx::detail::TimerList expired;
+    wheel.advance (tick, expired);
+
+    std::vector<RecordingNode*> nodes;
+    while (auto* node = expired.popFront())
+    {
+        nodes.push_back (static_cast<RecordingNode*> (node));
+    }
+
+    return nodes;
+}
+
+auto isFailure = [] (int statusCode) { return statusCode != 200; };
+auto alwaysRetry = [] (const std::exception&) { return true; };
+
+} // namespace
+
+RETRYXX_TEST (TimerWheelTest, ExpiresNodesAtTheirTickOnEveryLevel)
+{
+    retryxx::detail::TimerWheel wheel;
+
+    // One deadline inside each level: 256 ticks, 16k ticks, 1M ticks and beyond
+    std::vector<std::uint64_t> ticks { 5, 300, 20000, 2000000 };
+    std::vector<RecordingNode> nodes (ticks.size());
+
+    for (std::size_t i = 0; i < ticks.size(); ++i)
+    {
+        wheel.add (&nodes[i], ticks[i]);
+    }
+
+    CHECK (wheel.size() == ticks.size());
+
+    for (std::size_t i = 0; i < ticks.size(); ++i)
+    {
+        CHECK (advanceTo (wheel, ticks[i] - 1).empty());
+
+        auto expired = advanceTo (wheel, ticks[i]);
+        REQUIRE (expired.size() == 1);
+        CHECK (expired[0] == &nodes[i]);
+        CHECK (wheel.size() == ticks.size() - i - 1);
+    }
+
+    CHECK (! wheel.nextExpiry().has_value());
+}
+
+RETRYXX_TEST (TimerWheelTest, KeepsInsertionOrderWithinATick)
+{
+    retryxx::detail::TimerWheel wheel;
+    std::vector<RecordingNode> nodes (3);
+
+    for (auto& node : nodes)
+    {
+        wheel.add (&node, 10);
+    }
+
+    auto expired = advanceTo (wheel, 100);
+    REQUIRE (expired.size() == 3);
+    CHECK (expired[0] == &nodes[0]);
+    CHECK (expired[1] == &nodes[1]);
+    CHECK (expired[2] == &nodes[2]);
+}
+
+RETRYXX_TEST (TimerWheelTest, PastDeadlinesExpireOnTheNextAdvance)
+{
+    retryxx::detail::TimerWheel wheel;
+    advanceTo (wheel, 1000);
+
+    RecordingNode node;
+    wheel.add (&node, 10);
+
+    CHECK (wheel.nextExpiry() == std::optional<std::uint64_t> (1001));
+    CHECK (advanceTo (wheel, 1001).size() == 1);
+}
+
+RETRYXX_TEST (TimerWheelTest, RemovedNodesNeverExpire)
+{
+    retryxx::detail::TimerWheel wheel;
+    RecordingNode kept, removed, cascaded;
+
+    wheel.add (&kept, 50);
+    wheel.add (&removed, 60);
+    wheel.add (&cascaded, 5000);
+
+    CHECK (wheel.remove (&removed));
+    CHECK (! wheel.remove (&removed));
+    CHECK (wheel.remove (&cascaded));
+
+    auto expired = advanceTo (wheel, 10000);
+    REQUIRE (expired.size() == 1);
+    CHECK (expired[0] == &kept);
+    CHECK (wheel.size() == 0);
+}
+
+RETRYXX_TEST (TimerWheelTest, DrainReturnsEveryQueuedNode)
+{
+    retryxx::detail::TimerWheel wheel;
+    std::vector<RecordingNode> nodes (3);
+
+    wheel.add (&nodes[0], 1);
+    wheel.add (&nodes[1], 1000);
+    wheel.add (&nodes[2], 100000);
+
+    retryxx::detail::TimerList drained;
+    wheel.drain (drained);
+
+    int count = 0;
+    while (drained.popFront() != nullptr)
+    {
+        ++count;
+    }
+
+    CHECK (count == 3);
+    CHECK (wheel.size() == 0);
+}
+
+RETRYXX_TEST (RetryAsyncTest, RetriesOnTheScheduler)
+{
+    retryxx::RetryScheduler scheduler;
+    std::atomic<int> calls { 0 };
+
+    auto future = retryxx::retry_async (scheduler, [&]() { return ++calls < 3 ? 503 : 200; },
+                                        isFailure, alwaysRetry, 5, retryxx::BackoffPolicy (1ms, 1.0, 1ms));
+
+    auto result = future.get();
+    REQUIRE (result.has_value());
+    CHECK (*result == 200);
+    CHECK (calls == 3);
+    CHECK (scheduler.pending() == 0);
+}
+
+RETRYXX_TEST (RetryAsyncTest, ReportsExhaustionAndExceptions)
+{
+    retryxx::RetryScheduler scheduler;
+
+    auto exhausted = retryxx::retry_async (scheduler, []() { return 503; },
+                                           isFailure, alwaysRetry, 3, retryxx::BackoffPolicy (1ms, 1.0, 1ms)).get();
+    REQUIRE (! exhausted.has_value());
+    CHECK (exhausted.error().reason == retryxx::RetryErrorReason::exhausted);
+    CHECK (exhausted.error().attempts == 3);
+
+    auto nonRetryable = retryxx::retry_async (scheduler, []() -> int { throw std::logic_error ("bug"); },
+                                              isFailure, [] (const std::exception&) { return false; }).get();
+    REQUIRE (! nonRetryable.has_value());
+    CHECK (nonRetryable.error().reason == retryxx::RetryErrorReason::nonRetryableException);
+    CHECK (nonRetryable.error().attempts == 1);
+}
+
+RETRYXX_TEST (RetryAsyncTest, CancellationEndsTheBackoff)
+{
+    retryxx::RetryScheduler scheduler;
+    retryxx::stop_source source;
+
+    auto started = std::chrono::steady_clock::now();
+    auto future = retryxx::retry_async (scheduler, []() { return 503; },
+                                        isFailure, alwaysRetry, 5, retryxx::JitteredBackoffPolicy<retryxx::NoJitter> (10s, 1.0, 10s), source.get_token());
+
+    while (scheduler.pending() == 0)
+    {
+        std::this_thread::yield();
+    }
+
+    source.request_stop();
+    auto result = future.get();
+
+    REQUIRE (! result.has_value());
+    CHECK (result.error().reason == retryxx::RetryErrorReason::cancelled);
+    CHECK (result.error().attempts == 1);
+    CHECK (std::chrono::steady_clock::now() - started < 5s);
+}
+
+RETRYXX_TEST (RetryAsyncTest, ShutdownCancelsPendingRetries)
+{
+    std::future<retryxx::expected<int, retryxx::RetryError>> future;
+
+    {
+        retryxx::RetryScheduler scheduler;
+        future = retryxx::retry_async (scheduler, []() { return 503; },
+                                       isFailure, alwaysRetry, 5, retryxx::JitteredBackoffPolicy<retryxx::NoJitter> (10s, 1.0, 10s));
+
+        while (scheduler.pending() == 0)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    auto result = future.get();
+    REQUIRE (! result.has_value());
+    CHECK (result.error().reason == retryxx::RetryErrorReason::cancelled);
+}
+
+RETRYXX_TEST (RetryAsyncTest, ManyConcurrentRetriesShareOneThread)
+{
+    retryxx::RetryScheduler scheduler;
+    std::vector<std::future<retryxx::expected<int, retryxx::RetryError>>> futures;
+    std::atomic<int> calls { 0 };
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        futures.push_back (retryxx::retry_async (scheduler, [&, first = true]() mutable
+                                                 {
+                                                     ++calls;
+                                                     return std::exchange (first, false) ? 503 : 200;
+                                                 },
+                                                 isFailure, alwaysRetry, 3, retryxx::BackoffPolicy (5ms, 1.0, 5ms)));
+    }
+
+    int succeeded = 0;
+    for (auto& future : futures)
+    {
+        succeeded += future.get().has_value() ? 1 : 0;
+    }
+
+    CHECK (succeeded == 1000);
+    CHECK (calls == 2000);
+}
+
+RETRYXX_TEST_MAIN
@@ -0,0 +1,138 @@
+//
+//  retryxx_shared_memory_test.cpp
+//  retryxx
+//
+//  MIT License
+//
+//  Copyright (c) 2025 Jacob Sologub
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+
+#include <retryxx/retryxx_shared_memory.h>
+
+#include "retryxx_test.h"
+
+#include <string>
+
+#include <sys/wait.h>
+
+namespace
+{
+
+using SharedBudget = retryxx::SharedMemoryObject<retryxx::RetryBudget>;
+
+/// A segment name unique to this process, removed when the test starts and again when it ends
+struct ScopedSegmentName
+{
+    ScopedSegmentName()     { SharedBudget::remove (name); }
+    ~ScopedSegmentName()    { SharedBudget::remove (name); }
+
+    const std::string name = "/retryxx_tests." + std::to_string (::getpid());
+};
+
+} // namespace
+
+RETRYXX_TEST (SharedMemoryTest, SecondOpenAttachesToTheSameObject)
+{
+    ScopedSegmentName segment;
+    SharedBudget first (segment.name, 0.0, 1);
+    SharedBudget second (segment.name, 0.5, 100);
+
+    auto available = second->availableRetries();
+    REQUIRE (first->tryConsumeRetry());
+    CHECK (second->availableRetries() < available);
+}
+
+RETRYXX_TEST (SharedMemoryTest, AttachTimesOutWhenTheCreatorNeverFinished)
+{
+    ScopedSegmentName segment;
+    const auto& name = segment.name;
+
+    {
+        SharedBudget creator (name);
+    }
+
+    // Put the segment back into the state a creator that died mid-construction leaves behind
+    int fd = ::shm_open (name.c_str(), O_RDWR, 0);
+    REQUIRE (fd >= 0);
+    auto* state = static_cast<std::atomic<std::uint32_t>*> (::mmap (nullptr, sizeof (std::uint32_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+    ::close (fd);
+    REQUIRE (state != MAP_FAILED);
+    state->store (1);
+    ::munmap (state, sizeof (std::uint32_t));
+
+    auto started = std::chrono::steady_clock::now();
+
+    try
+    {
+        SharedBudget attacher (name);
+        CHECK (! "attached to an unconstructed segment");
+    }
+    catch (const std::system_error& e)
+    {
+        CHECK (e.code() == std::errc::timed_out);
+    }
+
+    CHECK (std::chrono::steady_clock::now() - started >= SharedBudget::attachTimeout);
+
+    SharedBudget::remove (name);
+    SharedBudget recreated (name);
+    CHECK (recreated->availableRetries() > 0.0);
+}
+
+RETRYXX_TEST (SharedMemoryTest, BreakerTrippedByAnotherProcessRefusesTheRetry)
+{
+    using SharedBreaker = retryxx::SharedMemoryObject<retryxx::CircuitBreaker>;
+    const auto name = "/retryxx_tests.breaker." + std::to_string (::getpid());
+    SharedBreaker::remove (name);
+
+    SharedBreaker breaker (name, 0.5, 1);
+    REQUIRE (breaker->getState() == retryxx::CircuitBreaker::State::closed);
+
+    auto child = ::fork();
+    REQUIRE (child >= 0);
+
+    if (child == 0)
+    {
+        SharedBreaker attached (name);
+        attached->recordFailure();
+        ::_exit (0);
+    }
+
+    int status = 0;
+    ::waitpid (child, &status, 0);
+    CHECK (WIFEXITED (status) && WEXITSTATUS (status) == 0);
+
+    int calls = 0;
+    auto result = retryxx::retry ([&]() { ++calls; return 200; },
+                                  [] (int statusCode) { return statusCode != 200; },
+                                  [] (const std::exception&) { return true; },
+                                  3, retryxx::BackoffPolicy{}, {},
+                                  retryxx::RetryOptions { .circuitBreaker = &breaker.get() });
+
+    REQUIRE (! result.has_value());
+    CHECK (result.error().reason == retryxx::RetryErrorReason::circuitOpen);
+    CHECK (calls == 0);
+
+    SharedBreaker::remove (name);
+}
+
+RETRYXX_TEST_MAIN
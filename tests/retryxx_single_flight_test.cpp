@@ -0,0 +1,234 @@
+//
+//  retryxx_single_flight_test.cpp
+//  retryxx
+//
+//  MIT License
+//
+//  Copyright (c) 2025 Jacob Sologub
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+
+#include <retryxx/retryxx_single_flight.h>
+
+#include "retryxx_test.h"
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+using namespace std::chrono_literals;
+
+auto isFailure = [] (int statusCode) { return statusCode != 200; };
+auto alwaysRetry = [] (const std::exception&) { return true; };
+
+/// Holds every attempt until released, so callers can pile up behind the leader
+struct Gate
+{
+    void wait() const
+    {
+        while (! open)
+        {
+            std::this_thread::sleep_for (1ms);
+        }
+    }
+
+    std::atomic<bool> open { false };
+};
+
+template <typename Flights>
+concept AcceptsMoveOnlyResults = requires (Flights& flights)
+{
+    flights.retry (1, [] { return std::unique_ptr<int>(); }, [] (const std::unique_ptr<int>&) { return false; }, alwaysRetry);
+};
+
+} // namespace
+
+RETRYXX_TEST (SingleFlightTest, ConcurrentCallersShareOneRetry)
+{
+    retryxx::SingleFlightRetry<std::string> flights;
+    Gate gate;
+    std::atomic<int> calls { 0 };
+    std::atomic<int> succeeded { 0 };
+
+    auto fetch = [&]
+    {
+        auto result = flights.retry ("user:1", [&]() { ++calls; gate.wait(); return 200; }, isFailure, alwaysRetry);
+        succeeded += result.has_value() && *result == 200 ? 1 : 0;
+    };
+
+    std::vector<std::thread> callers;
+    callers.emplace_back (fetch);
+
+    while (calls == 0)
+    {
+        std::this_thread::yield();
+    }
+
+    for (int i = 0; i < 7; ++i)
+    {
+        callers.emplace_back (fetch);
+    }
+
+    // Give the followers time to find the flight and start waiting on it
+    std::this_thread::sleep_for (200ms);
+    CHECK (flights.inFlight() == 1);
+    gate.open = true;
+
+    for (auto& caller : callers)
+    {
+        caller.join();
+    }
+
+    CHECK (calls == 1);
+    CHECK (succeeded == 8);
+    CHECK (flights.inFlight() == 0);
+}
+
+RETRYXX_TEST (SingleFlightTest, KeyIsReleasedOnceTheLeaderFinishes)
+{
+    retryxx::SingleFlightRetry<int> flights;
+    int calls = 0;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        CHECK (flights.retry (7, [&]() { ++calls; return 200; }, isFailure, alwaysRetry).has_value());
+    }
+
+    CHECK (calls == 3);
+    CHECK (flights.inFlight() == 0);
+}
+
+RETRYXX_TEST (SingleFlightTest, DifferentResultTypesAreNotCoalesced)
+{
+    retryxx::SingleFlightRetry<int> flights;
+    Gate gate;
+    std::atomic<bool> leaderStarted { false };
+
+    std::thread leader ([&]
+    {
+        flights.retry (1, [&]() { leaderStarted = true; gate.wait(); return 200; }, isFailure, alwaysRetry);
+    });
+
+    while (! leaderStarted)
+    {
+        std::this_thread::yield();
+    }
+
+    bool ran = false;
+    auto other = flights.retry (1, [&]() { ran = true; return std::string ("ok"); },
+                                [] (const std::string&) { return false; }, alwaysRetry);
+
+    gate.open = true;
+    leader.join();
+
+    CHECK (ran);
+    REQUIRE (other.has_value());
+    CHECK (*other == "ok");
+}
+
+RETRYXX_TEST (SingleFlightTest, WaiterCanStopWaiting)
+{
+    retryxx::SingleFlightRetry<int> flights;
+    Gate gate;
+    std::atomic<bool> leaderStarted { false };
+
+    std::thread leader ([&]
+    {
+        flights.retry (1, [&]() { leaderStarted = true; gate.wait(); return 200; }, isFailure, alwaysRetry);
+    });
+
+    while (! leaderStarted)
+    {
+        std::this_thread::yield();
+    }
+
+    retryxx::stop_source source;
+    std::thread canceller ([&]
+    {
+        std::this_thread::sleep_for (20ms);
+        source.request_stop();
+    });
+
+    auto result = flights.retry (1, []() { return 200; }, isFailure, alwaysRetry, 5, retryxx::BackoffPolicy{}, source.get_token());
+    canceller.join();
+    gate.open = true;
+    leader.join();
+
+    REQUIRE (! result.has_value());
+    CHECK (result.error().reason == retryxx::RetryErrorReason::cancelled);
+    CHECK (result.error().attempts == 0);
+}
+
+RETRYXX_TEST (SingleFlightTest, LeaderExceptionReachesTheWaiters)
+{
+    retryxx::SingleFlightRetry<int> flights;
+    Gate gate;
+    std::atomic<bool> leaderStarted { false };
+    std::atomic<int> rethrown { 0 };
+
+    auto fetch = [&]
+    {
+        try
+        {
+            flights.retry (1,
+                           [&]() -> int
+                           {
+                               leaderStarted = true;
+                               gate.wait();
+                               throw 42; // not a std::exception, so retry() does not catch it
+                           },
+                           isFailure, alwaysRetry, 1);
+        }
+        catch (int)
+        {
+            ++rethrown;
+        }
+    };
+
+    std::thread leader (fetch);
+
+    while (! leaderStarted)
+    {
+        std::this_thread::yield();
+    }
+
+    std::thread waiter (fetch);
+    std::this_thread::sleep_for (20ms);
+    gate.open = true;
+
+    leader.join();
+    waiter.join();
+
+    CHECK (rethrown == 2);
+}
+
+RETRYXX_TEST (SingleFlightTest, ResultsMustBeCopyable)
+{
+    CHECK (! AcceptsMoveOnlyResults<retryxx::SingleFlightRetry<int>>);
+}
+
+RETRYXX_TEST_MAIN
@@ -0,0 +1,112 @@
+//
+//  retryxx_static_policy_test.cpp
+//  retryxx
+//
+//  MIT License
+//
+//  Copyright (c) 2025 Jacob Sologub
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+
+#include <retryxx/retryxx_static_policy.h>
+#include <retryxx/retryxx_virtual_clock.h>
+
+#include "retryxx_test.h"
+
+namespace
+{
+
+using namespace std::chrono_literals;
+
+using ExactPolicy = retryxx::StaticBackoffPolicy<5, 100, 2.0, 500, retryxx::NoJitter>;
+
+auto isFailure = [] (int statusCode) { return statusCode != 200; };
+auto alwaysRetry = [] (const std::exception&) { return true; };
+
+} // namespace
+
+RETRYXX_TEST (StaticBackoffPolicyTest, ScheduleIsComputedAtCompileTime)
+{
+    static_assert (ExactPolicy::schedule.size() == 4);
+    static_assert (ExactPolicy::getBaseDelay (1) == 100ms);
+    static_assert (ExactPolicy::getBaseDelay (2) == 200ms);
+    static_assert (ExactPolicy::getBaseDelay (3) == 400ms);
+    static_assert (ExactPolicy::getBaseDelay (4) == 500ms);
+
+    // Past the end of the schedule, and before its start, the nearest entry is used
+    static_assert (ExactPolicy::getBaseDelay (10) == 500ms);
+    static_assert (ExactPolicy::getBaseDelay (0) == 100ms);
+
+    // A single attempt still has a one-entry schedule
+    static_assert (retryxx::StaticBackoffPolicy<1, 50, 2.0, 1000>::schedule.size() == 1);
+
+    CHECK (ExactPolicy{}.getDelay (3) == 400ms);
+}
+
+RETRYXX_TEST (StaticBackoffPolicyTest, FractionalMultipliersAreHonoured)
+{
+    using Policy = retryxx::StaticBackoffPolicy<4, 100, 1.5, 1000, retryxx::NoJitter>;
+
+    static_assert (Policy::getBaseDelay (2) == 150ms);
+    static_assert (Policy::getBaseDelay (3) == 225ms);
+    CHECK (Policy{}.getDelay (2) == 150ms);
+}
+
+RETRYXX_TEST (StaticBackoffPolicyTest, JitterStaysWithinTheSchedule)
+{
+    retryxx::StaticBackoffPolicy<8, 100, 2.0, 1000> policy;
+
+    for (int attempt = 1; attempt < 8; ++attempt)
+    {
+        auto delay = policy.getDelay (attempt);
+        CHECK (delay >= 0ms);
+        CHECK (delay <= policy.getBaseDelay (attempt));
+    }
+}
+
+RETRYXX_TEST (StaticBackoffPolicyTest, RetryTakesTheAttemptsAndDelaysFromThePolicy)
+{
+    retryxx::VirtualClock clock;
+    int calls = 0;
+
+    auto result = retryxx::retry<ExactPolicy> ([&]() { ++calls; return 503; }, isFailure, alwaysRetry, {},
+                                               retryxx::BasicRetryOptions<retryxx::NoObserver, retryxx::VirtualClock> { .clock = clock });
+
+    REQUIRE (! result.has_value());
+    CHECK (result.error().reason == retryxx::RetryErrorReason::exhausted);
+    CHECK (result.error().attempts == 5);
+    CHECK (calls == 5);
+    CHECK (clock.now().time_since_epoch() == 100ms + 200ms + 400ms + 500ms);
+}
+
+RETRYXX_TEST (StaticBackoffPolicyTest, RetrySucceedsEarly)
+{
+    int calls = 0;
+
+    auto result = retryxx::retry<retryxx::StaticBackoffPolicy<3, 1, 1.0, 1>> ([&]() { return ++calls < 2 ? 503 : 200; },
+                                                                                 isFailure, alwaysRetry);
+
+    REQUIRE (result.has_value());
+    CHECK (*result == 200);
+    CHECK (calls == 2);
+}
+
+RETRYXX_TEST_MAIN
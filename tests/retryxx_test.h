@@ -0,0 +1,126 @@
+//
+//  retryxx_test.h
+//  retryxx
+//
+//  MIT License
+//
+//  Copyright (c) 2025 Jacob Sologub
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+
+#pragma once
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+/// A minimal test runner so the tests build anywhere the headers do, without a framework.
+/// RETRYXX_TEST registers a test case, CHECK records a failure and carries on, and REQUIRE
+/// records one and leaves the test case. Every test file is its own executable whose main()
+/// is RETRYXX_TEST_MAIN; it runs the cases whose name contains its first argument, or all of them.
+namespace retryxx::test
+{
+
+struct TestCase
+{
+    const char* name;
+    void (*run)();
+};
+
+inline std::vector<TestCase>& registry()
+{
+    static std::vector<TestCase> testCases;
+    return testCases;
+}
+
+inline int& failures()
+{
+    static int count = 0;
+    return count;
+}
+
+inline bool registerTest (const char* name, void (*run)())
+{
+    registry().push_back ({ name, run });
+    return true;
+}
+
+inline void fail (const char* file, int line, const char* expression)
+{
+    std::fprintf (stderr, "%s:%d: check failed: %s\n", file, line, expression);
+    ++failures();
+}
+
+inline int runAll (int argc, char** argv)
+{
+    const char* filter = argc > 1 ? argv[1] : "";
+    int failedCases = 0;
+
+    for (const auto& testCase : registry())
+    {
+        if (std::strstr (testCase.name, filter) == nullptr)
+        {
+            continue;
+        }
+
+        auto before = failures();
+        testCase.run();
+
+        bool passed = failures() == before;
+        failedCases += passed ? 0 : 1;
+        std::printf ("[%s] %s\n", passed ? "  OK  " : " FAIL ", testCase.name);
+    }
+
+    return failedCases == 0 ? 0 : 1;
+}
+
+} // namespace retryxx::test
+
+#define RETRYXX_TEST(suite, name) \
+    static void suite##_##name(); \
+    [[maybe_unused]] static const bool suite##_##name##_registered = \
+        retryxx::test::registerTest (#suite "." #name, suite##_##name); \
+    static void suite##_##name()
+
+#define CHECK(...) \
+    do \
+    { \
+        if (! static_cast<bool> (__VA_ARGS__)) \
+        { \
+            retryxx::test::fail (__FILE__, __LINE__, #__VA_ARGS__); \
+        } \
+    } while (false)
+
+#define REQUIRE(...) \
+    do \
+    { \
+        if (! static_cast<bool> (__VA_ARGS__)) \
+        { \
+            retryxx::test::fail (__FILE__, __LINE__, #__VA_ARGS__); \
+            return; \
+        } \
+    } while (false)
+
+#define RETRYXX_TEST_MAIN \
+    int main (int argc, char** argv) \
+    { \
+        return retryxx::test::runAll (argc, argv); \
+    }
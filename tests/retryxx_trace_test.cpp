@@ -0,0 +1,176 @@
+//
+//  retryxx_trace_test.cpp
+//  retryxx
+//
+//  MIT License
+//
+//  Copyright (c) 2025 Jacob Sologub
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+
+#include <retryxx/retryxx_trace.h>
+#include <retryxx/retryxx_virtual_clock.h>
+
+#include "retryxx_test.h"
+
+#include <vector>
+
+namespace
+{
+
+using namespace std::chrono_literals;
+
+using VirtualTraceOptions = retryxx::BasicRetryOptions<retryxx::BasicTraceObserver<retryxx::VirtualClock>, retryxx::VirtualClock>;
+
+auto isFailure = [] (int statusCode) { return statusCode != 200; };
+auto alwaysRetry = [] (const std::exception&) { return true; };
+
+retryxx::JitteredBackoffPolicy<retryxx::NoJitter> exactBackoff()
+{
+    return { 100ms, 2.0, 10s };
+}
+
+std::vector<retryxx::AttemptRecord> drainAll (retryxx::TraceBuffer& traces)
+{
+    std::vector<retryxx::AttemptRecord> records;
+    traces.drain ([&] (const retryxx::AttemptRecord& record) { records.push_back (record); });
+    return records;
+}
+
+} // namespace
+
+RETRYXX_TEST (TraceBufferTest, RecordsEveryAttemptOfASampledRetry)
+{
+    retryxx::TraceBuffer traces (16);
+    retryxx::VirtualClock clock;
+    int calls = 0;
+
+    auto result = retryxx::retry ([&]() { clock.advance (10ms); return ++calls < 3 ? 503 : 200; },
+                                  isFailure, alwaysRetry, 5, exactBackoff(), {},
+                                  VirtualTraceOptions { .observer = traces.observe (clock), .clock = clock });
+
+    REQUIRE (result.has_value());
+
+    auto records = drainAll (traces);
+    REQUIRE (records.size() == 3);
+
+    using Outcome = retryxx::AttemptRecord::Outcome;
+    CHECK (records[0].outcome == Outcome::retrying && records[0].attempt == 1 && records[0].delayMilliseconds == 100);
+    CHECK (records[1].outcome == Outcome::retrying && records[1].attempt == 2 && records[1].delayMilliseconds == 200);
+    CHECK (records[2].outcome == Outcome::succeeded && records[2].attempt == 3);
+    CHECK (records[0].traceId == records[2].traceId);
+
+    // Stamped in virtual time: attempts of 10ms each, with 100ms and 200ms backoffs between them
+    CHECK (records[0].timestamp == std::chrono::nanoseconds (10ms).count());
+    CHECK (records[1].timestamp == std::chrono::nanoseconds (120ms).count());
+    CHECK (records[2].timestamp == std::chrono::nanoseconds (330ms).count());
+}
+
+RETRYXX_TEST (TraceBufferTest, RecordsAGiveUp)
+{
+    retryxx::TraceBuffer traces (16);
+    retryxx::VirtualClock clock;
+
+    auto result = retryxx::retry ([]() { return 503; }, isFailure, alwaysRetry, 2, exactBackoff(), {},
+                                  VirtualTraceOptions { .observer = traces.observe (clock), .clock = clock });
+
+    REQUIRE (! result.has_value());
+
+    auto records = drainAll (traces);
+    REQUIRE (records.size() == 2);
+    CHECK (records[1].outcome == retryxx::AttemptRecord::Outcome::gaveUp);
+    CHECK (records[1].reason == retryxx::RetryErrorReason::exhausted);
+    CHECK (records[1].attempt == 2);
+}
+
+RETRYXX_TEST (TraceBufferTest, SamplesOneRetryInNForEachBuffer)
+{
+    retryxx::TraceBuffer first (16, 3);
+    retryxx::TraceBuffer second (16, 3);
+    int firstSampled = 0;
+    int secondSampled = 0;
+
+    // Observing the two buffers in turn must not skew either one's sampling
+    for (int i = 0; i < 30; ++i)
+    {
+        firstSampled += first.observe().isSampled() ? 1 : 0;
+        secondSampled += second.observe().isSampled() ? 1 : 0;
+    }
+
+    CHECK (firstSampled == 10);
+    CHECK (secondSampled == 10);
+}
+
+RETRYXX_TEST (TraceBufferTest, UnsampledRetriesRecordNothing)
+{
+    retryxx::TraceBuffer traces (16, 1000);
+    retryxx::VirtualClock clock;
+
+    CHECK (traces.observe (clock).isSampled());
+
+    for (int i = 0; i < 10; ++i)
+    {
+        auto observer = traces.observe (clock);
+        CHECK (! observer.isSampled());
+
+        (void) retryxx::retry ([]() { return 503; }, isFailure, alwaysRetry, 3, exactBackoff(), {},
+                               VirtualTraceOptions { .observer = observer, .clock = clock });
+    }
+
+    CHECK (drainAll (traces).empty());
+}
+
+RETRYXX_TEST (TraceBufferTest, FullBufferDropsAndCountsNewRecords)
+{
+    retryxx::TraceBuffer traces (4);
+    retryxx::VirtualClock clock;
+    CHECK (traces.capacity() == 4);
+
+    (void) retryxx::retry ([]() { return 503; }, isFailure, alwaysRetry, 6, exactBackoff(), {},
+                           VirtualTraceOptions { .observer = traces.observe (clock), .clock = clock });
+
+    CHECK (traces.dropped() == 2);
+
+    auto records = drainAll (traces);
+    REQUIRE (records.size() == 4);
+    CHECK (records[3].attempt == 4);
+
+    // Draining frees the slots again
+    (void) retryxx::retry ([]() { return 200; }, isFailure, alwaysRetry, 6, exactBackoff(), {},
+                           VirtualTraceOptions { .observer = traces.observe (clock), .clock = clock });
+    CHECK (drainAll (traces).size() == 1);
+}
+
+RETRYXX_TEST (TraceBufferTest, DrainStopsAtMaxRecords)
+{
+    retryxx::TraceBuffer traces (16);
+    retryxx::VirtualClock clock;
+
+    (void) retryxx::retry ([]() { return 503; }, isFailure, alwaysRetry, 5, exactBackoff(), {},
+                           VirtualTraceOptions { .observer = traces.observe (clock), .clock = clock });
+
+    int seen = 0;
+    CHECK (traces.drain ([&] (const retryxx::AttemptRecord&) { ++seen; }, 2) == 2);
+    CHECK (seen == 2);
+    CHECK (drainAll (traces).size() == 3);
+}
+
+RETRYXX_TEST_MAIN
@@ -0,0 +1,396 @@
+//
+//  retryxx_sim.cpp
+//  retryxx
+//
+//  MIT License
+//
+//  Copyright (c) 2025 Jacob Sologub
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//
+
+// Simulates a crowd of clients retrying against one server in virtual time and reports
+// how each retry strategy spreads the load: requests per interval, the time until every
+// client has finished, and how many requests were sent per client.
+//
+//     retryxx_sim [--clients=1000] [--capacity=50] [--tick=10] [--outage=2000] ...
+//
+// Every client makes one call at the start, or spread over --spread ms. The server
+// rejects everything during the initial outage, then accepts up to --capacity requests
+// per --tick ms and rejects the rest, plus a random --failure fraction of the ones it
+// accepts. All clients share one RetryBudget and one CircuitBreaker where a strategy
+// uses them, as callers in one service sharing collaborators for a dependency would.
+
+#include <retryxx/retryxx_retry.h>
+#include <retryxx/retryxx_virtual_clock.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <queue>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+
+struct Config
+{
+    int clients = 1000;
+    int capacity = 50;
+    std::chrono::milliseconds tick { 10 };
+    std::chrono::milliseconds outage { 2000 };
+    std::chrono::milliseconds spread { 0 };
+    double failureRate = 0.0;
+    int maxAttempts = 10;
+    std::chrono::milliseconds initialDelay { 100 };
+    double multiplier = 2.0;
+    std::chrono::milliseconds maxDelay { 10000 };
+    std::chrono::milliseconds interval { 500 };
+    std::uint64_t seed = 1;
+};
+
+constexpr std::size_t numReasons = static_cast<std::size_t> (retryxx::RetryErrorReason::invalidArgument) + 1;
+
+struct Report
+{
+    const char* name = "";
+    std::vector<long> requestsPerInterval;
+    std::chrono::milliseconds completion { 0 };
+    long requests = 0;
+    long firstAttempts = 0;
+    long succeeded = 0;
+    std::array<long, numReasons> gaveUp {};
+};
+
+struct RetryOnRejection
+{
+    bool operator() (int status) const noexcept { return status != 200; }
+};
+
+struct NoExceptionsExpected
+{
+    bool operator() (const std::exception&) const noexcept { return false; }
+};
+
+/// The server: an outage, then a fixed capacity per tick with random failures on top
+class Server
+{
+public:
+    explicit Server (const Config& config)
+      : config (config),
+        rng (config.seed)
+    {
+    }
+
+    int handle (std::chrono::steady_clock::duration now)
+    {
+        auto tick = now / config.tick;
+
+        if (tick != currentTick)
+        {
+            currentTick = tick;
+            load = 0;
+        }
+
+        ++load;
+
+        if (now < config.outage || load > config.capacity)
+        {
+            return 503;
+        }
+
+        return std::uniform_real_distribution<double> (0.0, 1.0) (rng) < config.failureRate ? 500 : 200;
+    }
+
+private:
+    const Config& config;
+    retryxx::SplitMix64 rng;
+    std::int64_t currentTick = -1;
+    int load = 0;
+};
+
+template <typename Policy>
+Report simulate (const char* name,
+                 const Config& config,
+                 Policy backoffPolicy,
+                 retryxx::RetryBudget* budget = nullptr,
+                 retryxx::CircuitBreaker* circuitBreaker = nullptr)
+{
+    using Loop = retryxx::detail::RetryLoop<int, RetryOnRejection, NoExceptionsExpected, Policy,
+                                            retryxx::NoObserver, retryxx::VirtualClock>;
+
+    struct Event
+    {
+        std::chrono::steady_clock::duration time;
+        std::uint64_t sequence;
+        std::size_t client;
+
+        bool operator> (const Event& other) const noexcept
+        {
+            return time != other.time ? time > other.time : sequence > other.sequence;
+        }
+    };
+
+    // Every strategy sees the same jitter sequence and the same failures for a given seed
+    retryxx::detail::threadLocalRng<typename Policy::RandomEngine>() = typename Policy::RandomEngine (config.seed);
+
+    retryxx::VirtualClock clock;
+    retryxx::BasicRetryOptions<retryxx::NoObserver, retryxx::VirtualClock> options { .budget = budget,
+                                                                                    .circuitBreaker = circuitBreaker,
+                                                                                    .clock = clock };
+    Server server (config);
+    Report report;
+    report.name = name;
+
+    std::vector<Loop> loops;
+    loops.reserve (static_cast<std::size_t> (config.clients));
+    std::vector<bool> attempted (static_cast<std::size_t> (config.clients), false);
+
+    std::priority_queue<Event, std::vector<Event>, std::greater<>> events;
+    std::uint64_t nextSequence = 0;
+    retryxx::SplitMix64 arrivals (config.seed ^ 0x5eed);
+
+    for (std::size_t client = 0; client < static_cast<std::size_t> (config.clients); ++client)
+    {
+        loops.emplace_back (RetryOnRejection{}, NoExceptionsExpected{}, config.maxAttempts, backoffPolicy, options);
+        auto start = config.spread.count() > 0 ? std::chrono::milliseconds (arrivals() % static_cast<std::uint64_t> (config.spread.count()))
+                                               : std::chrono::milliseconds (0);
+        events.push ({ start, nextSequence++, client });
+    }
+
+    auto finish = [&] (Loop& loop, std::chrono::steady_clock::duration now)
+    {
+        if (auto result = loop.takeResult())
+        {
+            ++report.succeeded;
+        }
+        else
+        {
+            ++report.gaveUp[static_cast<std::size_t> (result.error().reason)];
+        }
+
+        report.completion = std::max (report.completion, std::chrono::ceil<std::chrono::milliseconds> (now));
+    };
+
+    while (! events.empty())
+    {
+        auto event = events.top();
+        events.pop();
+
+        clock.advance (event.time - clock.now().time_since_epoch());
+        auto& loop = loops[event.client];
+
+        if (! loop.beginAttempt())
+        {
+            finish (loop, event.time);
+            continue;
+        }
+
+        auto interval = static_cast<std::size_t> (event.time / config.interval);
+
+        if (interval >= report.requestsPerInterval.size())
+        {
+            report.requestsPerInterval.resize (interval + 1);
+        }
+
+        ++report.requestsPerInterval[interval];
+        ++report.requests;
+
+        if (! attempted[event.client])
+        {
+            attempted[event.client] = true;
+            ++report.firstAttempts;
+        }
+
+        if (loop.onResult (server.handle (event.time)))
+        {
+            finish (loop, event.time);
+            continue;
+        }
+
+        events.push ({ event.time + loop.nextDelay(), nextSequence++, event.client });
+    }
+
+    return report;
+}
+
+void print (const Config& config, const std::vector<Report>& reports)
+{
+    std::printf ("%d clients, server down for %lld ms then taking %d requests per %lld ms with %.0f%% failures\n",
+                 config.clients, static_cast<long long> (config.outage.count()), config.capacity,
+                 static_cast<long long> (config.tick.count()), config.failureRate * 100.0);
+    std::printf ("%d attempts, backoff from %lld ms x%.2f up to %lld ms\n\n",
+                 config.maxAttempts, static_cast<long long> (config.initialDelay.count()), config.multiplier,
+                 static_cast<long long> (config.maxDelay.count()));
+
+    std::size_t intervals = 0;
+    for (const auto& report : reports)
+    {
+        intervals = std::max (intervals, report.requestsPerInterval.size());
+    }
+
+    std::printf ("requests per %lld ms, server capacity %lld\n%10s", static_cast<long long> (config.interval.count()),
+                 static_cast<long long> (config.capacity * (config.interval / config.tick)), "ms");
+
+    for (const auto& report : reports)
+    {
+        std::printf ("%14s", report.name);
+    }
+
+    std::printf ("\n");
+
+    for (std::size_t i = 0; i < intervals; ++i)
+    {
+        std::printf ("%10lld", static_cast<long long> ((config.interval * static_cast<long long> (i)).count()));
+
+        for (const auto& report : reports)
+        {
+            std::printf ("%14ld", i < report.requestsPerInterval.size() ? report.requestsPerInterval[i] : 0L);
+        }
+
+        std::printf ("\n");
+    }
+
+    auto row = [&] (const char* label, auto value)
+    {
+        std::printf ("%-14s", label);
+
+        for (const auto& report : reports)
+        {
+            std::printf ("%14s", value (report).c_str());
+        }
+
+        std::printf ("\n");
+    };
+
+    std::printf ("\n%-14s", "");
+    for (const auto& report : reports)
+    {
+        std::printf ("%14s", report.name);
+    }
+
+    std::printf ("\n");
+
+    row ("completion ms", [] (const Report& r) { return std::to_string (r.completion.count()); });
+    row ("requests", [] (const Report& r) { return std::to_string (r.requests); });
+    row ("callers", [] (const Report& r) { return std::to_string (r.firstAttempts); });
+    row ("amplification", [] (const Report& r)
+    {
+        char text[32];
+        std::snprintf (text, sizeof (text), "%.2fx", static_cast<double> (r.requests) / static_cast<double> (std::max (r.firstAttempts, 1L)));
+        return std::string (text);
+    });
+    row ("succeeded", [] (const Report& r) { return std::to_string (r.succeeded); });
+    row ("exhausted", [] (const Report& r) { return std::to_string (r.gaveUp[static_cast<std::size_t> (retryxx::RetryErrorReason::exhausted)]); });
+    row ("over budget", [] (const Report& r) { return std::to_string (r.gaveUp[static_cast<std::size_t> (retryxx::RetryErrorReason::budgetExhausted)]); });
+    row ("circuit open", [] (const Report& r) { return std::to_string (r.gaveUp[static_cast<std::size_t> (retryxx::RetryErrorReason::circuitOpen)]); });
+}
+
+template <typename Jitter>
+retryxx::JitteredBackoffPolicy<Jitter> makePolicy (const Config& config)
+{
+    return retryxx::JitteredBackoffPolicy<Jitter> (config.initialDelay, config.multiplier, config.maxDelay);
+}
+
+struct Option
+{
+    std::string_view name;
+    void (*apply) (Config&, double);
+};
+
+std::chrono::milliseconds toMilliseconds (double value)
+{
+    return std::chrono::milliseconds (std::max (static_cast<long long> (value), 0LL));
+}
+
+constexpr Option options[] =
+{
+    { "clients",    [] (Config& c, double v) { c.clients = std::max (static_cast<int> (v), 0); } },
+    { "capacity",   [] (Config& c, double v) { c.capacity = std::max (static_cast<int> (v), 0); } },
+    { "tick",       [] (Config& c, double v) { c.tick = std::max (toMilliseconds (v), std::chrono::milliseconds (1)); } },
+    { "outage",     [] (Config& c, double v) { c.outage = toMilliseconds (v); } },
+    { "spread",     [] (Config& c, double v) { c.spread = toMilliseconds (v); } },
+    { "failure",    [] (Config& c, double v) { c.failureRate = std::clamp (v, 0.0, 1.0); } },
+    { "attempts",   [] (Config& c, double v) { c.maxAttempts = std::max (static_cast<int> (v), 1); } },
+    { "initial",    [] (Config& c, double v) { c.initialDelay = toMilliseconds (v); } },
+    { "multiplier", [] (Config& c, double v) { c.multiplier = v; } },
+    { "max",        [] (Config& c, double v) { c.maxDelay = toMilliseconds (v); } },
+    { "interval",   [] (Config& c, double v) { c.interval = std::max (toMilliseconds (v), std::chrono::milliseconds (1)); } },
+    { "seed",       [] (Config& c, double v) { c.seed = static_cast<std::uint64_t> (v); } },
+};
+
+/// Reads --name=value arguments into config, returning false on anything it does not recognise
+bool parse (int argc, char** argv, Config& config)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string_view argument (argv[i]);
+        auto equals = argument.find ('=');
+
+        if (! argument.starts_with ("--") || equals == std::string_view::npos)
+        {
+            return false;
+        }
+
+        auto name = argument.substr (2, equals - 2);
+        auto option = std::find_if (std::begin (options), std::end (options), [&] (const Option& o) { return o.name == name; });
+
+        if (option == std::end (options))
+        {
+            return false;
+        }
+
+        option->apply (config, std::strtod (std::string (argument.substr (equals + 1)).c_str(), nullptr));
+    }
+
+    return true;
+}
+
+} // namespace
+
+int main (int argc, char** argv)
+{
+    Config config;
+
+    if (! parse (argc, argv, config))
+    {
+        std::fprintf (stderr,
+                      "usage: retryxx_sim [--clients=N] [--capacity=N] [--tick=ms] [--outage=ms] [--spread=ms]\n"
+                      "                   [--failure=0..1] [--attempts=N] [--initial=ms] [--multiplier=x] [--max=ms]\n"
+                      "                   [--interval=ms] [--seed=N]\n");
+        return 1;
+    }
+
+    retryxx::RetryBudget budget;
+    retryxx::CircuitBreaker circuitBreaker (0.5, 20, std::chrono::seconds (1), std::chrono::seconds (1));
+
+    std::vector<Report> reports;
+    reports.push_back (simulate ("no jitter", config, makePolicy<retryxx::NoJitter> (config)));
+    reports.push_back (simulate ("full", config, makePolicy<retryxx::FullJitter> (config)));
+    reports.push_back (simulate ("decorrelated", config, makePolicy<retryxx::DecorrelatedJitter> (config)));
+    reports.push_back (simulate ("full+budget", config, makePolicy<retryxx::FullJitter> (config), &budget));
+    reports.push_back (simulate ("full+breaker", config, makePolicy<retryxx::FullJitter> (config), nullptr, &circuitBreaker));
+
+    print (config, reports);
+    return 0;
+}